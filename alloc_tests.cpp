@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------
+// Allocation regression tests.
+//
+// The global allocation functions are replaced by counting ones, so that the
+// hashing calls documented as not allocating can be checked to stay that way.
+//------------------------------------------------------------------------------
+#define BOOST_TEST_MODULE alloc_tests
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "hashes.h"
+
+namespace
+{
+
+std::size_t allocations( 0 );
+
+} // namespace
+
+
+void* operator new( std::size_t size )
+{
+   ++allocations;
+   if( void* ptr = std::malloc( size == 0 ? 1 : size ) ) { return ptr; }
+   throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t size )
+{
+   return operator new( size );
+}
+
+void* operator new( std::size_t size, std::align_val_t alignment )
+{
+   ++allocations;
+   std::size_t const align( static_cast< std::size_t >( alignment ) );
+   if( void* ptr = std::aligned_alloc( align, ( size + align - 1 ) / align * align ) )
+   {
+      return ptr;
+   }
+   throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t size, std::align_val_t alignment )
+{
+   return operator new( size, alignment );
+}
+
+void operator delete( void* ptr ) noexcept { std::free( ptr ); }
+void operator delete[]( void* ptr ) noexcept { std::free( ptr ); }
+void operator delete( void* ptr, std::size_t ) noexcept { std::free( ptr ); }
+void operator delete[]( void* ptr, std::size_t ) noexcept { std::free( ptr ); }
+void operator delete( void* ptr, std::align_val_t ) noexcept { std::free( ptr ); }
+void operator delete[]( void* ptr, std::align_val_t ) noexcept { std::free( ptr ); }
+void operator delete( void* ptr, std::size_t, std::align_val_t ) noexcept { std::free( ptr ); }
+void operator delete[]( void* ptr, std::size_t, std::align_val_t ) noexcept { std::free( ptr ); }
+
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Number of allocations made while running fn.
+template< typename Fn >
+std::size_t allocationsDuring( Fn&& fn )
+{
+   std::size_t const before( allocations );
+   fn();
+   return allocations - before;
+}
+
+
+//------------------------------------------------------------------------------
+// Every non allocating entry point of an algorithm, on messages of one and
+// several chunks.  The very first calls are included : binding the backend
+// must not allocate either.
+template< typename Algo >
+void checkNoAllocation()
+{
+   std::string const longMsg( 1000, 'x' );
+   std::string_view const msgs[] = { "", "abc", longMsg };
+   char hex[hashes::Digest<Algo>::hex_size];
+
+   for( std::string_view msg : msgs )
+   {
+      auto input = reinterpret_cast< std::uint8_t const* >( msg.data() );
+
+      hashes::Digest<Algo> digest;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+                            digest = hashes::hashDigest<Algo>( msg ); } ), 0u );
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+                            hashes::hashStrg<Algo>( input, msg.size(), hex ); } ), 0u );
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() { digest.toHex( hex ); } ), 0u );
+
+      hashes::Digest<Algo> parsed;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+         hashes::Digest<Algo>::fromHex( std::string_view( hex, sizeof( hex ) ), parsed ); } ), 0u );
+      BOOST_CHECK( parsed == digest );
+
+      hashes::Hasher<Algo> hasher;
+      hashes::Digest<Algo> streamed;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+         hasher.update( msg.substr( 0, msg.size() / 3 ) );
+         hasher.update( msg.substr( msg.size() / 3 ) );
+         hasher.finalize( streamed ); } ), 0u );
+      BOOST_CHECK( streamed == digest );
+
+      hashes::Hasher<Algo> snapshot;
+      hashes::Digest<Algo> finished;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+         snapshot.update( msg.substr( 0, msg.size() / 3 ) );
+         hashes::Hasher<Algo> fork( snapshot.fork() );
+         snapshot.finalizeWith( msg.data() + msg.size() / 3, msg.size() - msg.size() / 3,
+                                finished );
+         fork.update( msg.substr( msg.size() / 3 ) ).finalize( streamed ); } ), 0u );
+      BOOST_CHECK( finished == digest );
+      BOOST_CHECK( streamed == digest );
+
+      hashes::Hmac<Algo> hmac( longMsg );
+      hashes::Digest<Algo> mac, macStreamed;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+         hmac.mac( msg.data(), msg.size(), mac );
+         hmac.update( msg );
+         hmac.finalize( macStreamed ); } ), 0u );
+      BOOST_CHECK( mac == macStreamed );
+
+      hashes::Hash<Algo> theHash;
+      BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+         hashes::initializeHash( theHash );
+         hashes::processBlocks<Algo>( theHash.state, input,
+                                      msg.size() / ( Algo::chunk_size / CHAR_BIT ) );
+         hashes::getDigest( theHash, digest );
+         hashes::getDigest( theHash, hex ); } ), 0u );
+   }
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( alloc_tests )
+
+BOOST_AUTO_TEST_CASE( counting_works )
+{
+   // The string returning API allocates : if this is not seen, the counting
+   // allocation functions are not in use and the other tests prove nothing
+   BOOST_CHECK_GT( allocationsDuring( []() {
+                      volatile std::size_t len(
+                         hashes::hashStrg<hashes::SHA512>( "abc" ).size() );
+                      (void)len; } ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( hashing_does_not_allocate )
+{
+   checkNoAllocation<hashes::MD5>();
+   checkNoAllocation<hashes::SHA1>();
+   checkNoAllocation<hashes::SHA256>();
+   checkNoAllocation<hashes::SHA224>();
+   checkNoAllocation<hashes::SHA512>();
+   checkNoAllocation<hashes::SHA384>();
+   checkNoAllocation<hashes::SHA512_224>();
+   checkNoAllocation<hashes::SHA512_256>();
+}
+
+BOOST_AUTO_TEST_CASE( sha256d_does_not_allocate )
+{
+   std::vector< std::uint8_t > const inputs( 64 * 9, 0x5a );
+   std::vector< std::uint8_t > digests( 32 * 9 );
+   hashes::Digest<hashes::SHA256> digest;
+
+   BOOST_CHECK_EQUAL( allocationsDuring( [&]() {
+      hashes::sha256d64( inputs.data(), 9, digests.data() );
+      digest = hashes::sha256d( inputs.data(), 64 );
+      digest = hashes::sha256d( inputs.data(), 100 ); } ), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,732 @@
+//------------------------------------------------------------------------------
+// Throughput benchmarks for the hashing kernels.
+//
+// Build with CMAKE_BUILD_TYPE=Release, the default Debug build does not
+// optimize.  On x86, cycles are time stamp counter cycles : they tick at the
+// nominal frequency, not at the turbo one.
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "hashes.h"
+
+#if HDQRT_X86_BACKENDS
+#  include <x86intrin.h>
+#endif
+
+namespace
+{
+
+std::size_t const bufferLen( 1 << 20 );
+int const repetitions( 16 );
+
+
+//------------------------------------------------------------------------------
+// Best of a few runs, in cycles (or nanoseconds without a TSC) per byte.
+double perByte( std::function< void() > const& run, std::size_t bytes )
+{
+   double best( 1e300 );
+   for( int rep( 0 ); rep != repetitions; ++rep )
+   {
+#if HDQRT_X86_BACKENDS
+      std::uint64_t start( __rdtsc() );
+      run();
+      double elapsed( static_cast< double >( __rdtsc() - start ) );
+#else
+      auto start( std::chrono::steady_clock::now() );
+      run();
+      double elapsed( std::chrono::duration< double, std::nano >(
+                           std::chrono::steady_clock::now() - start ).count() );
+#endif
+      best = std::min( best, elapsed / static_cast< double >( bytes ) );
+   }
+   return best;
+}
+
+
+//------------------------------------------------------------------------------
+void report( char const* name, std::function< void() > const& run,
+             std::size_t bytes )
+{
+#if HDQRT_X86_BACKENDS
+   char const* unit( "cycles/byte" );
+#else
+   char const* unit( "ns/byte" );
+#endif
+   std::printf( "%-44s %8.2f %s\n", name, perByte( run, bytes ), unit );
+}
+
+
+//------------------------------------------------------------------------------
+// Portable SHA2 kernel with the given rounds and schedule policies.
+template< typename Algo, typename Rounds, typename Schedule >
+void sha2Kernel( char const* name, std::vector< std::uint8_t > const& buffer )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   hashes::Hash<Algo> theHash;
+   hashes::initializeHash( theHash );
+
+   report( name, [&]()
+   {
+      hashes::details::processBlocks< Algo, Rounds, Schedule >(
+                  theHash.state, buffer.data(), buffer.size() / chunkBytes,
+                  std::true_type() );
+   }, buffer.size() );
+
+   // Keep the result alive
+   if( theHash.state[0] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// Every backend of Algo available on this CPU.
+template< typename Algo >
+void backends( char const* algoName, std::vector< std::uint8_t > const& buffer )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::BMI2,
+                                    hashes::Backend::SSSE3, hashes::Backend::SHA_NI } )
+   {
+      hashes::blocks_fn<Algo> blocks( hashes::backendBlocks<Algo>( backend ) );
+      if( blocks == nullptr ) { continue; }
+
+      hashes::Hash<Algo> theHash;
+      hashes::initializeHash( theHash );
+      std::string name( std::string( algoName ) + " " + hashes::backendName( backend ) );
+      report( name.c_str(), [&]()
+      {
+         blocks( theHash.state, buffer.data(), buffer.size() / chunkBytes );
+      }, buffer.size() );
+
+      if( theHash.state[0] == 0 ) { std::puts( "" ); }
+   }
+   std::printf( "%-44s %8s\n", "selected",
+                hashes::backendName( hashes::selectedBackend<Algo>() ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+// Zero chunks kernel of every backend of Algo, against its chunk kernel on a
+// buffer of zeros.
+template< typename Algo >
+void zeroBackends( char const* algoName )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   std::vector< std::uint8_t > const zeros( bufferLen );
+
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::BMI2,
+                                    hashes::Backend::SSSE3, hashes::Backend::SHA_NI } )
+   {
+      hashes::blocks_fn<Algo> blocks( hashes::backendBlocks<Algo>( backend ) );
+      if( blocks == nullptr ) { continue; }
+      hashes::zero_blocks_fn<Algo> zeroBlocks( hashes::backendZeroBlocks<Algo>( backend ) );
+
+      hashes::Hash<Algo> theHash;
+      hashes::initializeHash( theHash );
+      std::string name( std::string( algoName ) + " " + hashes::backendName( backend ) );
+      report( ( name + ", zeros read" ).c_str(), [&]()
+      {
+         blocks( theHash.state, zeros.data(), zeros.size() / chunkBytes );
+      }, zeros.size() );
+      report( ( name + ", zero chunks kernel" ).c_str(), [&]()
+      {
+         zeroBlocks( theHash.state, zeros.size() / chunkBytes );
+      }, zeros.size() );
+
+      if( theHash.state[0] == 0 ) { std::puts( "" ); }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+// One shot hashing through the selected backend, messages of msgLen bytes.
+template< typename Algo >
+void oneShot( char const* name, std::vector< std::uint8_t > const& buffer,
+              std::size_t msgLen )
+{
+   char out[hashes::Digest<Algo>::hex_size];
+   std::size_t const nbOfMsgs( buffer.size() / msgLen );
+
+   report( name, [&]()
+   {
+      for( std::size_t msg( 0 ); msg != nbOfMsgs; ++msg )
+      {
+         hashes::hashStrg<Algo>( buffer.data() + msg * msgLen, msgLen, out );
+      }
+   }, nbOfMsgs * msgLen );
+
+   if( out[0] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// Records of a common prefix followed by recordLen bytes of their own : the
+// whole record hashed each time, and the records finished from a snapshot
+// of the prefix.  Per byte of the records' own data.
+template< typename Algo >
+void prefixSnapshots( char const* name, std::vector< std::uint8_t > const& buffer,
+                      std::size_t prefixLen, std::size_t recordLen )
+{
+   std::size_t const nbOfRecords( ( buffer.size() - prefixLen ) / recordLen );
+   std::vector< std::uint8_t > record( buffer.begin(), buffer.begin() + prefixLen + recordLen );
+   hashes::Digest<Algo> digest;
+
+   report( ( std::string( name ) + ", whole" ).c_str(), [&]()
+   {
+      for( std::size_t idx( 0 ); idx != nbOfRecords; ++idx )
+      {
+         std::copy_n( buffer.begin() + prefixLen + idx * recordLen, recordLen,
+                      record.begin() + prefixLen );
+         digest = hashes::hashDigest<Algo>( record.data(), record.size() );
+      }
+   }, nbOfRecords * recordLen );
+
+   hashes::Hasher<Algo> snapshot;
+   snapshot.update( buffer.data(), prefixLen );
+   report( ( std::string( name ) + ", snapshot" ).c_str(), [&]()
+   {
+      for( std::size_t idx( 0 ); idx != nbOfRecords; ++idx )
+      {
+         snapshot.finalizeWith( buffer.data() + prefixLen + idx * recordLen, recordLen, digest );
+      }
+   }, nbOfRecords * recordLen );
+
+   if( digest.bytes[0] == 0 && digest.bytes[1] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// HMAC of msgLen bytes messages under one key : with the key states cached,
+// and setting the key again for every message as a one-off HMAC would.
+template< typename Algo >
+void hmacs( char const* name, std::vector< std::uint8_t > const& buffer, std::size_t msgLen )
+{
+   std::string const key( "a key shorter than a chunk" );
+   std::size_t const nbOfMsgs( buffer.size() / msgLen );
+   hashes::Digest<Algo> digest;
+
+   hashes::Hmac<Algo> hmac( key );
+   report( ( std::string( name ) + ", cached key" ).c_str(), [&]()
+   {
+      for( std::size_t msg( 0 ); msg != nbOfMsgs; ++msg )
+      {
+         hmac.mac( buffer.data() + msg * msgLen, msgLen, digest );
+      }
+   }, nbOfMsgs * msgLen );
+
+   report( ( std::string( name ) + ", key set per message" ).c_str(), [&]()
+   {
+      for( std::size_t msg( 0 ); msg != nbOfMsgs; ++msg )
+      {
+         hmac.setKey( key.data(), key.size() );
+         hmac.mac( buffer.data() + msg * msgLen, msgLen, digest );
+      }
+   }, nbOfMsgs * msgLen );
+
+   if( digest.bytes[0] == 0 && digest.bytes[1] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// Wall time of a PBKDF2 derivation per iteration : the library, and the
+// iterations written over Hmac::mac, which pads every U again.
+template< typename Algo >
+void pbkdf2s( char const* name, std::uint32_t iterations )
+{
+   constexpr std::size_t digestBytes( hashes::Digest<Algo>::size );
+
+   auto perIteration = [&]( std::string const& label, std::function< void() > const& run )
+   {
+      double best( 1e300 );
+      for( int rep( 0 ); rep != 4; ++rep )
+      {
+         auto start( std::chrono::steady_clock::now() );
+         run();
+         best = std::min( best, std::chrono::duration< double, std::nano >(
+                                   std::chrono::steady_clock::now() - start ).count() );
+      }
+      std::printf( "%-44s %8.1f ns/iteration\n", label.c_str(),
+                   best / static_cast< double >( iterations ) );
+   };
+
+   std::uint8_t key[2 * digestBytes];
+   perIteration( std::string( name ) + ", Hmac::mac loop", [&]()
+   {
+      hashes::Hmac<Algo> const hmac( "password" );
+      hashes::Digest<Algo> u, block;
+      std::uint8_t const salt[] = { 's', 'a', 'l', 't', 0, 0, 0, 1 };
+      hmac.mac( salt, sizeof( salt ), u );
+      block = u;
+      for( std::uint32_t iter( 1 ); iter < iterations; ++iter )
+      {
+         hmac.mac( u.bytes.data(), digestBytes, u );
+         for( std::size_t idx( 0 ); idx != digestBytes; ++idx ) { block.bytes[idx] ^= u.bytes[idx]; }
+      }
+      std::copy( block.bytes.begin(), block.bytes.end(), key );
+   } );
+   perIteration( std::string( name ) + ", pbkdf2" , [&]()
+   {
+      hashes::pbkdf2<Algo>( "password", 8, "salt", 4, iterations, key, digestBytes );
+   } );
+   perIteration( std::string( name ) + ", pbkdf2 two blocks, one thread", [&]()
+   {
+      hashes::pbkdf2<Algo>( "password", 8, "salt", 4, iterations, key, sizeof( key ), 1 );
+   } );
+   perIteration( std::string( name ) + ", pbkdf2 two blocks, two threads", [&]()
+   {
+      hashes::pbkdf2<Algo>( "password", 8, "salt", 4, iterations, key, sizeof( key ), 2 );
+   } );
+
+   if( key[0] == 0 && key[1] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// SHA256( SHA256( x ) ) of 64 bytes inputs : two hashDigest calls, then the
+// sha256d64 kernel of each backend.  Per byte of input.
+void doubleSha256( std::vector< std::uint8_t > const& buffer )
+{
+   std::size_t const nbOfInputs( buffer.size() / 64 );
+   std::vector< std::uint8_t > digests( 32 * nbOfInputs );
+
+   report( "hashDigest of hashDigest", [&]()
+   {
+      for( std::size_t idx( 0 ); idx != nbOfInputs; ++idx )
+      {
+         hashes::Digest<hashes::SHA256> const inner(
+                        hashes::hashDigest<hashes::SHA256>( buffer.data() + 64 * idx, 64 ) );
+         hashes::Digest<hashes::SHA256> const outer(
+                        hashes::hashDigest<hashes::SHA256>( inner.bytes.data(), inner.size ) );
+         std::copy( outer.bytes.begin(), outer.bytes.end(), digests.begin() + 32 * idx );
+      }
+   }, buffer.size() );
+
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::BMI2,
+                                    hashes::Backend::SHA_NI, hashes::Backend::AVX2 } )
+   {
+      hashes::sha256d64_fn const kernel( hashes::backendSha256d64( backend ) );
+      if( kernel == nullptr ) { continue; }
+
+      report( ( std::string( "sha256d64 " ) + hashes::backendName( backend ) ).c_str(), [&]()
+      {
+         kernel( buffer.data(), nbOfInputs, digests.data() );
+      }, buffer.size() );
+   }
+
+   if( digests[0] == 0 && digests[1] == 0 ) { std::puts( "" ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+// Hex encoding of a SHA256 digest, per input byte.
+void hexEncoders()
+{
+   int const digests( 1 << 14 );
+   std::uint8_t digest[32];
+   for( std::size_t idx( 0 ); idx != sizeof( digest ); ++idx )
+   {
+      digest[idx] = static_cast< std::uint8_t >( idx * 29 + 3 );
+   }
+   char out[64];
+
+   auto encode = [&]( char const* name, char* (*encoder)( std::uint8_t const*, std::size_t, char* ) )
+   {
+      report( name, [&]()
+      {
+         for( int rep( 0 ); rep != digests; ++rep )
+         {
+            encoder( digest, sizeof( digest ), out );
+            digest[0] ^= static_cast< std::uint8_t >( out[63] );
+         }
+      }, digests * sizeof( digest ) );
+   };
+
+   encode( "table", &bits::details::toHexTable );
+#if HDQRT_X86_BACKENDS
+   if( cpu::hasSsse3() ) { encode( "ssse3", &bits::details::toHexSsse3 ); }
+   if( cpu::hasAvx2() ) { encode( "avx2", &bits::details::toHexAvx2 ); }
+#endif
+
+   hashes::Hash<hashes::SHA256> theHash;
+   hashes::initializeHash( theHash );
+   std::size_t total( 0 );
+   report( "getDigest", [&]()
+   {
+      for( int rep( 0 ); rep != digests; ++rep )
+      {
+         theHash.state[0] += static_cast< std::uint32_t >( rep );
+         total += hashes::getDigest( theHash ).size();
+      }
+   }, digests * sizeof( digest ) );
+
+   if( total == 0 ) { std::puts( "" ); }
+}
+
+
+
+#if HDQRT_POSIX_FILES
+//------------------------------------------------------------------------------
+// SHA256 of a cached file : mapped, read() loop, and read into a string.
+void files( std::vector< std::uint8_t > const& buffer )
+{
+   std::size_t const copies( 64 );
+   char path[] = "/tmp/hdqrt_bench_XXXXXX";
+   int fd( ::mkstemp( path ) );
+   if( fd < 0 ) { std::puts( "cannot create a temporary file" ); return; }
+   for( std::size_t copy( 0 ); copy != copies; ++copy )
+   {
+      if( ::write( fd, buffer.data(), buffer.size() ) != static_cast< ssize_t >( buffer.size() ) )
+      {
+         std::puts( "cannot write the temporary file" );
+         break;
+      }
+   }
+   ::close( fd );
+
+   std::size_t const fileSize( copies * buffer.size() );
+   std::size_t total( 0 );
+   hashes::FileOptions readLoop;
+   readLoop.forceRead = true;
+
+   report( "hashFile, mapped", [&]()
+   {
+      total += hashes::hashFile<hashes::SHA256>( path ).size();
+   }, fileSize );
+   report( "hashFile, read loop", [&]()
+   {
+      total += hashes::hashFile<hashes::SHA256>( path, readLoop ).size();
+   }, fileSize );
+   hashes::FileOptions pipelined;
+   pipelined.pipelined = true;
+   hashes::PipelineStats stats;
+   report( "hashFile, pipelined reader", [&]()
+   {
+      int in( ::open( path, O_RDONLY ) );
+      hashes::Digest<hashes::SHA256> digest;
+      hashes::hashFilePipelined<hashes::SHA256>( in, digest, stats, pipelined );
+      ::close( in );
+      total += digest.size;
+   }, fileSize );
+   std::printf( "%-44s %8.2f ms reader, %.2f ms hasher\n", "  stalled (last run)",
+                std::chrono::duration< double, std::milli >( stats.readerStalled ).count(),
+                std::chrono::duration< double, std::milli >( stats.hasherStalled ).count() );
+   report( "read into a string, hashStrg", [&]()
+   {
+      std::string content( fileSize, '\0' );
+      int in( ::open( path, O_RDONLY ) );
+      std::size_t done( 0 );
+      for( ssize_t got( 1 ); got > 0 && done != fileSize; done += static_cast< std::size_t >( got ) )
+      {
+         got = ::read( in, &content[done], fileSize - done );
+      }
+      ::close( in );
+      total += hashes::hashStrg<hashes::SHA256>( content ).size();
+   }, fileSize );
+
+   ::unlink( path );
+   if( total == 0 ) { std::puts( "" ); }
+}
+
+
+//------------------------------------------------------------------------------
+// Pages of a file in the page cache, in MiB.
+double cachedMiB( char const* path, std::size_t fileSize )
+{
+   int fd( ::open( path, O_RDONLY ) );
+   void* addr( ::mmap( nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0 ) );
+   ::close( fd );
+   if( addr == MAP_FAILED ) { return -1.0; }
+
+   std::size_t const pageSize( static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) ) );
+   std::vector< unsigned char > resident( ( fileSize + pageSize - 1 ) / pageSize );
+   ::mincore( addr, fileSize, resident.data() );
+   ::munmap( addr, fileSize );
+   std::size_t const pages( static_cast< std::size_t >(
+                               std::count_if( resident.begin(), resident.end(),
+                                              []( unsigned char page ) { return page & 1; } ) ) );
+   return static_cast< double >( pages * pageSize ) / ( 1 << 20 );
+}
+
+
+//------------------------------------------------------------------------------
+// SHA256 of a file out of the page cache : throughput of one run, and how
+// much of the file the run left in the cache.
+void uncachedFile( std::vector< std::uint8_t > const& buffer )
+{
+   std::size_t const copies( 256 );
+   char path[] = "/var/tmp/hdqrt_bench_XXXXXX";
+   int fd( ::mkstemp( path ) );
+   if( fd < 0 ) { std::puts( "cannot create a temporary file" ); return; }
+   for( std::size_t copy( 0 ); copy != copies; ++copy )
+   {
+      if( ::write( fd, buffer.data(), buffer.size() ) != static_cast< ssize_t >( buffer.size() ) )
+      {
+         std::puts( "cannot write the temporary file" );
+         break;
+      }
+   }
+   ::fsync( fd );
+
+   std::size_t const fileSize( copies * buffer.size() );
+   std::printf( "\nSHA256 of a %zu MiB file out of the page cache\n", fileSize >> 20 );
+
+   std::size_t total( 0 );
+   auto run = [&]( char const* name, hashes::FileOptions const& options )
+   {
+      ::posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+      auto start( std::chrono::steady_clock::now() );
+      total += hashes::hashFile<hashes::SHA256>( path, options ).size();
+      double const elapsed( std::chrono::duration< double >(
+                                 std::chrono::steady_clock::now() - start ).count() );
+      std::printf( "%-44s %8.0f MiB/s, %4.0f MiB left cached\n", name,
+                   static_cast< double >( fileSize >> 20 ) / elapsed,
+                   cachedMiB( path, fileSize ) );
+   };
+
+   run( "hashFile, mapped", hashes::FileOptions() );
+   hashes::FileOptions readLoop;
+   readLoop.forceRead = true;
+   run( "hashFile, read loop", readLoop );
+   for( std::size_t depth : { 1, 8, 32 } )
+   {
+      hashes::FileOptions direct;
+      direct.direct = true;
+      direct.queueDepth = depth;
+      hashes::FileOptions dropCache;
+      dropCache.dropCache = true;
+      dropCache.queueDepth = depth;
+      std::string const suffix( ", queue depth " + std::to_string( depth ) );
+      run( ( "hashFile, O_DIRECT" + suffix ).c_str(), direct );
+      run( ( "hashFile, DONTNEED" + suffix ).c_str(), dropCache );
+   }
+
+   ::close( fd );
+   ::unlink( path );
+   if( total == 0 ) { std::puts( "" ); }
+}
+
+//------------------------------------------------------------------------------
+// SHA256 of a 1 GiB sparse file in the page cache : 4 MiB of data every
+// 128 MiB, the rest holes.
+void sparseFile( std::vector< std::uint8_t > const& buffer )
+{
+   std::size_t const fileSize( std::size_t( 1 ) << 30 );
+   char path[] = "/var/tmp/hdqrt_bench_XXXXXX";
+   int fd( ::mkstemp( path ) );
+   if( fd < 0 || ::ftruncate( fd, static_cast< off_t >( fileSize ) ) != 0 )
+   {
+      std::puts( "cannot create a temporary file" );
+      return;
+   }
+   for( std::size_t offset( 0 ); offset < fileSize; offset += std::size_t( 128 ) << 20 )
+   {
+      for( std::size_t copy( 0 ); copy != 4; ++copy )
+      {
+         if( ::pwrite( fd, buffer.data(), buffer.size(),
+                       static_cast< off_t >( offset + copy * buffer.size() ) ) < 0 )
+         {
+            std::puts( "cannot write the temporary file" );
+         }
+      }
+   }
+   ::close( fd );
+
+   std::printf( "\nSHA256 of a 1 GiB sparse file, 32 MiB of data\n" );
+   std::size_t total( 0 );
+   hashes::FileOptions dense;
+   dense.skipHoles = false;
+   report( "hashFile, holes read", [&]()
+   {
+      total += hashes::hashFile<hashes::SHA256>( path, dense ).size();
+   }, fileSize );
+   report( "hashFile, holes skipped", [&]()
+   {
+      total += hashes::hashFile<hashes::SHA256>( path ).size();
+   }, fileSize );
+
+   ::unlink( path );
+   if( total == 0 ) { std::puts( "" ); }
+}
+
+//------------------------------------------------------------------------------
+// Wall time of one run per file : the tree is too big to run it many times.
+void perFile( char const* name, std::function< void() > const& run, std::size_t nbOfFiles )
+{
+   auto start( std::chrono::steady_clock::now() );
+   run();
+   double const elapsed( std::chrono::duration< double, std::micro >(
+                              std::chrono::steady_clock::now() - start ).count() );
+   std::printf( "%-44s %8.2f us/file\n", name, elapsed / static_cast< double >( nbOfFiles ) );
+}
+
+
+//------------------------------------------------------------------------------
+// SHA256 of a tree of small files, 1000 per directory, sizes up to 4 KiB.
+// HDQRT_BENCH_FILES sets the number of files, one million by default.
+void fileTree( std::vector< std::uint8_t > const& buffer )
+{
+   char const* env( std::getenv( "HDQRT_BENCH_FILES" ) );
+   std::size_t const nbOfFiles( env != nullptr ? std::strtoull( env, nullptr, 10 ) : 1000000 );
+   std::printf( "\nSHA256 of %zu small files in the page cache, io_uring %s\n", nbOfFiles,
+                hashes::ioUringAvailable() ? "available" : "unavailable" );
+
+   char root[] = "/tmp/hdqrt_tree_XXXXXX";
+   if( ::mkdtemp( root ) == nullptr ) { std::puts( "cannot create a temporary directory" ); return; }
+   std::vector< std::string > paths;
+   paths.reserve( nbOfFiles );
+   for( std::size_t idx( 0 ); idx != nbOfFiles; ++idx )
+   {
+      std::string const dir( std::string( root ) + "/" + std::to_string( idx / 1000 ) );
+      if( idx % 1000 == 0 ) { ::mkdir( dir.c_str(), 0700 ); }
+      paths.push_back( dir + "/" + std::to_string( idx % 1000 ) );
+
+      int fd( ::open( paths.back().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600 ) );
+      std::size_t const size( idx * 2654435761u % 4097 );
+      if( fd < 0 || ::write( fd, buffer.data() + idx % 4096, size ) != static_cast< ssize_t >( size ) )
+      {
+         std::puts( "cannot write the tree" );
+         paths.pop_back();
+         if( fd >= 0 ) { ::close( fd ); }
+         break;
+      }
+      ::close( fd );
+   }
+
+   std::size_t total( 0 );
+   perFile( "hashFile, one file after the other", [&]()
+   {
+      hashes::Digest<hashes::SHA256> digest;
+      for( std::string const& path : paths )
+      {
+         hashes::hashFile<hashes::SHA256>( path, digest );
+         total += digest.size;
+      }
+   }, paths.size() );
+   hashes::BatchOptions pool;
+   pool.forceThreadPool = true;
+   perFile( "hashFiles, thread pool", [&]()
+   {
+      total += hashes::hashFiles<hashes::SHA256>( paths, pool ).size();
+   }, paths.size() );
+   perFile( "hashFiles, io_uring", [&]()
+   {
+      total += hashes::hashFiles<hashes::SHA256>( paths ).size();
+   }, paths.size() );
+   hashes::BatchOptions workers;
+   workers.workers = 2;
+   perFile( "hashFiles, io_uring, 2 hashing workers", [&]()
+   {
+      total += hashes::hashFiles<hashes::SHA256>( paths, workers ).size();
+   }, paths.size() );
+
+   for( std::size_t idx( 0 ); idx != paths.size(); ++idx )
+   {
+      ::unlink( paths[idx].c_str() );
+      if( idx % 1000 == 999 || idx + 1 == paths.size() )
+      {
+         ::rmdir( ( std::string( root ) + "/" + std::to_string( idx / 1000 ) ).c_str() );
+      }
+   }
+   ::rmdir( root );
+   if( total == 0 ) { std::puts( "" ); }
+}
+#endif
+
+} // namespace
+
+
+int main()
+{
+   std::vector< std::uint8_t > buffer( bufferLen );
+   for( std::size_t idx( 0 ); idx != buffer.size(); ++idx )
+   {
+      buffer[idx] = static_cast< std::uint8_t >( idx * 131 + 7 );
+   }
+
+   using hashes::details::LoopRounds;
+   using hashes::details::UnrolledRounds;
+   using hashes::details::FullSchedule;
+   using hashes::details::RollingSchedule;
+
+   std::printf( "Portable SHA2 kernel, %zu bytes per run\n", buffer.size() );
+   sha2Kernel< hashes::SHA256, LoopRounds, FullSchedule >(
+                     "SHA256 loop rounds, full schedule", buffer );
+   sha2Kernel< hashes::SHA256, UnrolledRounds, FullSchedule >(
+                     "SHA256 unrolled rounds, full schedule", buffer );
+   sha2Kernel< hashes::SHA256, LoopRounds, RollingSchedule >(
+                     "SHA256 loop rounds, rolling schedule", buffer );
+   sha2Kernel< hashes::SHA256, UnrolledRounds, RollingSchedule >(
+                     "SHA256 unrolled rounds, rolling schedule", buffer );
+   sha2Kernel< hashes::SHA512, LoopRounds, FullSchedule >(
+                     "SHA512 loop rounds, full schedule", buffer );
+   sha2Kernel< hashes::SHA512, UnrolledRounds, FullSchedule >(
+                     "SHA512 unrolled rounds, full schedule", buffer );
+   sha2Kernel< hashes::SHA512, LoopRounds, RollingSchedule >(
+                     "SHA512 loop rounds, rolling schedule", buffer );
+   sha2Kernel< hashes::SHA512, UnrolledRounds, RollingSchedule >(
+                     "SHA512 unrolled rounds, rolling schedule", buffer );
+
+   std::printf( "\nBackends, %zu bytes per run\n", buffer.size() );
+   backends< hashes::MD5 >( "MD5", buffer );
+   backends< hashes::SHA1 >( "SHA1", buffer );
+   backends< hashes::SHA256 >( "SHA256", buffer );
+   backends< hashes::SHA512 >( "SHA512", buffer );
+
+   std::printf( "\nZero chunks, %zu bytes per run\n", buffer.size() );
+   zeroBackends< hashes::SHA256 >( "SHA256" );
+   zeroBackends< hashes::SHA512 >( "SHA512" );
+
+   std::printf( "\nOne shot, MD5 and SHA1 against SHA256\n" );
+   oneShot< hashes::MD5 >( "MD5 1 MiB messages", buffer, buffer.size() );
+   oneShot< hashes::SHA256 >( "SHA256 1 MiB messages", buffer, buffer.size() );
+   oneShot< hashes::SHA1 >( "SHA1 1 MiB messages", buffer, buffer.size() );
+   oneShot< hashes::MD5 >( "MD5 4 KiB messages", buffer, 4096 );
+   oneShot< hashes::SHA256 >( "SHA256 4 KiB messages", buffer, 4096 );
+   oneShot< hashes::MD5 >( "MD5 64 bytes messages", buffer, 64 );
+   oneShot< hashes::SHA256 >( "SHA256 64 bytes messages", buffer, 64 );
+
+   std::printf( "\nDouble SHA256 of 64 bytes inputs\n" );
+   doubleSha256( buffer );
+
+   std::printf( "\nRecords sharing a prefix, per byte after the prefix\n" );
+   prefixSnapshots< hashes::SHA256 >( "SHA256 4 KiB + 64 bytes", buffer, 4096, 64 );
+   prefixSnapshots< hashes::SHA256 >( "SHA256 100 + 64 bytes", buffer, 100, 64 );
+
+   std::printf( "\nHMAC of many messages under one key\n" );
+   hmacs< hashes::SHA256 >( "SHA256 64 bytes", buffer, 64 );
+   hmacs< hashes::SHA256 >( "SHA256 1 KiB", buffer, 1024 );
+   hmacs< hashes::SHA512 >( "SHA512 64 bytes", buffer, 64 );
+
+   std::printf( "\nPBKDF2, 100000 iterations\n" );
+   pbkdf2s< hashes::SHA256 >( "SHA256", 100000 );
+   pbkdf2s< hashes::SHA512 >( "SHA512", 100000 );
+
+   std::printf( "\nHex encoding of 32 bytes digests\n" );
+   hexEncoders();
+
+#if HDQRT_POSIX_FILES
+   std::printf( "\nSHA256 of a %zu MiB file in the page cache\n", 64 * buffer.size() >> 20 );
+   files( buffer );
+   uncachedFile( buffer );
+   sparseFile( buffer );
+   fileTree( buffer );
+#endif
+
+   return 0;
+}
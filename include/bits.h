@@ -2,9 +2,15 @@
 #define HDQRT_GENERAL_BITS_H_
 
 #include <cstdint>
+#include <cstddef> // for std::size_t
+#include <array>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <iostream>
 
+#include "cpu.h"
+
 
 namespace bits
 {
@@ -27,7 +33,24 @@ enum class Endianness : std::uint_fast8_t
 
 
 //------------------------------------------------------------------------------
-Endianness endianness();
+/*!
+ *  @brief Endianness of the target, known at compile time.
+ */
+#if defined( __BYTE_ORDER__ ) && defined( __ORDER_LITTLE_ENDIAN__ ) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr Endianness native_endianness = Endianness::LITTLE;
+#elif defined( __BYTE_ORDER__ ) && defined( __ORDER_BIG_ENDIAN__ ) && \
+      __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr Endianness native_endianness = Endianness::BIG;
+#elif defined( _MSC_VER )
+constexpr Endianness native_endianness = Endianness::LITTLE;
+#else
+constexpr Endianness native_endianness = Endianness::UNKNOWN;
+#endif
+
+
+//------------------------------------------------------------------------------
+constexpr Endianness endianness();
 
 //------------------------------------------------------------------------------
 std::ostream& operator << ( std::ostream& ostrm, Endianness endianness );
@@ -41,15 +64,55 @@ template<typename UIntType>
 std::array< std::uint8_t, sizeof(UIntType) > unpack( UIntType nb );
 
 template< typename T >
-typename std::enable_if< std::is_integral<T>::value, T >::type
+constexpr typename std::enable_if< std::is_integral<T>::value, T >::type
 byte_swap( T const& x );
 
+template< typename UIntType >
+UIntType load_be( std::uint8_t const* src );
+
+template< typename UIntType >
+void load_be( UIntType* dest, std::uint8_t const* src, std::size_t count );
+
+template< typename UIntType >
+void store_be( std::uint8_t* dest, UIntType val );
+
+template< typename UIntType >
+void store_be( std::uint8_t* dest, UIntType const* src, std::size_t count );
+
+std::uint32_t load_be32( std::uint8_t const* src );
+
+std::uint64_t load_be64( std::uint8_t const* src );
+
+void store_be32( std::uint8_t* dest, std::uint32_t val );
+
+void store_be64( std::uint8_t* dest, std::uint64_t val );
+
+template< typename UIntType >
+UIntType load_le( std::uint8_t const* src );
+
+template< typename UIntType >
+void load_le( UIntType* dest, std::uint8_t const* src, std::size_t count );
+
+template< typename UIntType >
+void store_le( std::uint8_t* dest, UIntType val );
+
+template< typename UIntType >
+void store_le( std::uint8_t* dest, UIntType const* src, std::size_t count );
+
+std::uint32_t load_le32( std::uint8_t const* src );
+
+std::uint64_t load_le64( std::uint8_t const* src );
+
+void store_le32( std::uint8_t* dest, std::uint32_t val );
+
+void store_le64( std::uint8_t* dest, std::uint64_t val );
+
 template< typename IntType >
-IntType bit_rotate_lt( IntType const& val, std::uint_fast16_t moves );
+constexpr IntType bit_rotate_lt( IntType const& val, std::uint_fast16_t moves );
 
 
 template< typename IntType >
-IntType bit_rotate_rt( IntType const& val, std::uint_fast16_t moves );
+constexpr IntType bit_rotate_rt( IntType const& val, std::uint_fast16_t moves );
 
 
 template< typename IntType >
@@ -77,6 +140,15 @@ setNthBit( IntType const& val, std::uint_fast16_t set );
 template<typename UIntType>
 std::string to_hex( UIntType nb );
 
+template<typename UIntType>
+char* to_hex( UIntType nb, char* out );
+
+char* to_hex( std::uint8_t const* bytes, std::size_t len, char* out );
+
+constexpr bool from_hex( char const* hex, std::size_t len, std::uint8_t* out );
+
+constexpr bool from_hex( std::string_view hex, std::uint8_t* out );
+
 
 } // namespace bits
 
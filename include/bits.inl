@@ -2,9 +2,15 @@
 
 #include <iostream>
 #include <algorithm>
+#include <climits> // for CHAR_BIT
+#include <cstring> // for std::memcpy
 
 #include "always_inline.h"
 
+#if HDQRT_X86_BACKENDS || defined( __SSSE3__ )
+#  include <immintrin.h>
+#endif
+
 
 
 namespace bits
@@ -15,16 +21,12 @@ namespace bits
  *  @brief Get system endianness.  Not exhaustive.
  *
  *  Supports only LITTLE_ENDIAN and BIG_ENDIAN.  MIXED_ENDIAN systems will
- *  result in unknown.
+ *  result in unknown.  Known at compile time, see native_endianness.
  *
  */
-ALWAYS_INLINE Endianness endianness()
+ALWAYS_INLINE constexpr Endianness endianness()
 {
-   std::uint32_t one( 1 );
-   // (first == 1)   ? LITTLE : ( ( last == 1 ) ? BIG : UNKNOWN )
-   return ( (reinterpret_cast<char*>( &one ))[0] == 1 ) ? Endianness::LITTLE :
-          ( ( (reinterpret_cast<char*>( &one ))[sizeof( std::uint32_t )] == 1 ) ?
-                           Endianness::BIG : Endianness::UNKNOWN );
+   return native_endianness;
 }
 
 
@@ -87,51 +89,14 @@ ALWAYS_INLINE std::uint32_t pack( std::uint16_t x1, std::uint16_t x2 )
 
 
 //------------------------------------------------------------------------------
-template<>
-ALWAYS_INLINE std::array<std::uint8_t, 1> unpack<std::uint8_t>( std::uint8_t nb )
-{
-   std::array<std::uint8_t, 1> pack;
-   pack[0] = nb;
-   return pack;
-}
-
-
-
-//------------------------------------------------------------------------------
-template<>
-ALWAYS_INLINE std::array<std::uint8_t, 2> unpack<std::uint16_t>( std::uint16_t nb )
-{
-   std::array<std::uint8_t, 2> pack;
-   pack[0] = ( ( nb & 0xff00 ) >> 8 );
-   pack[1] =   ( nb & 0x00ff );
-   return pack;
-}
-
-
-template<>
-ALWAYS_INLINE std::array<std::uint8_t, 4> unpack<std::uint32_t>( std::uint32_t nb )
+/*!
+ *  @brief Bytes of an unsigned integer, most significant first.
+ */
+template<typename UIntType>
+ALWAYS_INLINE std::array<std::uint8_t, sizeof(UIntType)> unpack( UIntType nb )
 {
-   std::array<std::uint8_t, 4> pack;
-   pack[0] = ( ( nb & 0xff000000 ) >> 24 );
-   pack[1] = ( ( nb & 0x00ff0000 ) >> 16 );
-   pack[2] = ( ( nb & 0x0000ff00 ) >>  8 );
-   pack[3] =   ( nb & 0x000000ff );
-   return pack;
-}
-
-
-template<>
-ALWAYS_INLINE std::array<std::uint8_t, 8> unpack<std::uint64_t>( std::uint64_t nb )
-{
-   std::array<std::uint8_t, 8> pack;
-   pack[0] = ( ( nb & 0xff00000000000000 ) >> 56 );
-   pack[1] = ( ( nb & 0x00ff000000000000 ) >> 48 );
-   pack[2] = ( ( nb & 0x0000ff0000000000 ) >> 40 );
-   pack[3] = ( ( nb & 0x000000ff00000000 ) >> 32 );
-   pack[4] = ( ( nb & 0x00000000ff000000 ) >> 24 );
-   pack[5] = ( ( nb & 0x0000000000ff0000 ) >> 16 );
-   pack[6] = ( ( nb & 0x000000000000ff00 ) >>  8 );
-   pack[7] =   ( nb & 0x00000000000000ff );
+   std::array<std::uint8_t, sizeof(UIntType)> pack;
+   store_be( pack.data(), nb );
    return pack;
 }
 
@@ -144,11 +109,17 @@ ALWAYS_INLINE std::array<std::uint8_t, 8> unpack<std::uint64_t>( std::uint64_t n
  *  any support for MIXED_ENDIAN.
  */
 template< typename T >
-ALWAYS_INLINE typename std::enable_if< std::is_integral<T>::value, T >::type
+ALWAYS_INLINE constexpr typename std::enable_if< std::is_integral<T>::value, T >::type
 byte_swap( T const& x )
 {
-   unsigned char *memp = reinterpret_cast<unsigned char*>(x);
-   std::reverse(memp, memp + sizeof(T));
+   typedef typename std::make_unsigned<T>::type unsigned_t;
+   unsigned_t const bits( static_cast<unsigned_t>( x ) );
+   unsigned_t swapped( 0 );
+   for( std::size_t idx( 0 ); idx != sizeof( T ); ++idx )
+   {
+      swapped = static_cast<unsigned_t>( ( swapped << 8 ) | ( ( bits >> ( 8 * idx ) ) & 0xff ) );
+   }
+   return static_cast<T>( swapped );
 }
 
 
@@ -158,11 +129,15 @@ byte_swap( T const& x )
  *  @brief Template specialization for 16 bit integers.
  */
 template<>
-ALWAYS_INLINE typename std::enable_if< std::is_integral<std::uint16_t>::value, std::uint16_t >::type
+ALWAYS_INLINE constexpr typename std::enable_if< std::is_integral<std::uint16_t>::value, std::uint16_t >::type
 byte_swap<std::uint16_t>( std::uint16_t const& x )
 {
-    return ( (x >> 8) |
-             (x << 8)   );
+#if defined( __GNUC__ ) || defined( __clang__ )
+   return __builtin_bswap16( x );
+#else
+    return static_cast<std::uint16_t>( (x >> 8) |
+                                       (x << 8)   );
+#endif
 }
 
 
@@ -172,13 +147,17 @@ byte_swap<std::uint16_t>( std::uint16_t const& x )
  *  @brief Template specialization for 32 bit integers.
  */
 template<>
-ALWAYS_INLINE typename std::enable_if< std::is_integral<std::uint16_t>::value, std::uint32_t >::type
+ALWAYS_INLINE constexpr typename std::enable_if< std::is_integral<std::uint16_t>::value, std::uint32_t >::type
 byte_swap<std::uint32_t>( std::uint32_t const& x )
 {
+#if defined( __GNUC__ ) || defined( __clang__ )
+   return __builtin_bswap32( x );
+#else
     return ( ( x >> 24 )                 |
              ( ( x << 8 ) & 0x00FF0000 ) |
              ( ( x >> 8 ) & 0x0000FF00 ) |
              ( x << 24 )                   );
+#endif
 }
 
 
@@ -188,9 +167,12 @@ byte_swap<std::uint32_t>( std::uint32_t const& x )
  *  @brief Template specialization for 64 bit integers.
  */
 template<>
-ALWAYS_INLINE typename std::enable_if< std::is_integral<std::uint64_t>::value, std::uint64_t >::type
+ALWAYS_INLINE constexpr typename std::enable_if< std::is_integral<std::uint64_t>::value, std::uint64_t >::type
 byte_swap<std::uint64_t>( std::uint64_t const& x )
 {
+#if defined( __GNUC__ ) || defined( __clang__ )
+   return __builtin_bswap64( x );
+#else
     return ( ( x >> 56 )                          |
              ( ( x << 40 ) & 0x00FF000000000000 ) |
              ( ( x << 24 ) & 0x0000FF0000000000 ) |
@@ -199,6 +181,350 @@ byte_swap<std::uint64_t>( std::uint64_t const& x )
              ( ( x >> 24 ) & 0x0000000000FF0000 ) |
              ( ( x >> 40 ) & 0x000000000000FF00 ) |
              ( x << 56 )                            );
+#endif
+}
+
+
+
+namespace details
+{
+
+#if defined( __SSSE3__ )
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Shuffle reversing the bytes of each word of a 16 bytes vector.
+ */
+template< std::size_t wordSize >
+ALWAYS_INLINE __m128i byteSwapMask()
+{
+   return ( wordSize == 8 ) ? _mm_set_epi64x( 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL )
+                            : _mm_set_epi64x( 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+}
+#endif
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Copy count words between memory and words, swapping the bytes of
+ *         each.
+ *
+ *  16 bytes at a time with a byte shuffle when compiled for SSSE3 (32 with
+ *  AVX2), one bswap per word otherwise.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void
+swapCopy( void* dest, void const* src, std::size_t count )
+{
+   auto out = static_cast< std::uint8_t* >( dest );
+   auto in = static_cast< std::uint8_t const* >( src );
+   std::size_t bytes( count * sizeof( UIntType ) );
+
+#if defined( __AVX2__ )
+   __m256i const mask256( _mm256_broadcastsi128_si256( byteSwapMask< sizeof( UIntType ) >() ) );
+   for( ; bytes >= 32; bytes -= 32, in += 32, out += 32 )
+   {
+      _mm256_storeu_si256( reinterpret_cast< __m256i* >( out ), _mm256_shuffle_epi8(
+            _mm256_loadu_si256( reinterpret_cast< __m256i const* >( in ) ), mask256 ) );
+   }
+#endif
+#if defined( __SSSE3__ )
+   __m128i const mask( byteSwapMask< sizeof( UIntType ) >() );
+   for( ; bytes >= 16; bytes -= 16, in += 16, out += 16 )
+   {
+      _mm_storeu_si128( reinterpret_cast< __m128i* >( out ), _mm_shuffle_epi8(
+            _mm_loadu_si128( reinterpret_cast< __m128i const* >( in ) ), mask ) );
+   }
+#endif
+
+   for( ; bytes != 0; bytes -= sizeof( UIntType ), in += sizeof( UIntType ),
+                                                   out += sizeof( UIntType ) )
+   {
+      UIntType word;
+      std::memcpy( &word, in, sizeof( UIntType ) );
+      word = byte_swap( word );
+      std::memcpy( out, &word, sizeof( UIntType ) );
+   }
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Read a BIG_ENDIAN unsigned integer from unaligned memory.
+ *
+ *  One load and one bswap (or a movbe) on little endian targets.
+ */
+template< typename UIntType >
+ALWAYS_INLINE UIntType load_be( std::uint8_t const* src )
+{
+   static_assert( std::is_unsigned<UIntType>::value,
+                  "load_be reads unsigned integers only." );
+
+   if constexpr( native_endianness == Endianness::LITTLE ||
+                 native_endianness == Endianness::BIG )
+   {
+      UIntType word;
+      std::memcpy( &word, src, sizeof( UIntType ) );
+      return ( native_endianness == Endianness::LITTLE ) ? byte_swap( word ) : word;
+   }
+   else
+   {
+      UIntType word( 0 );
+      for( std::size_t idx( 0 ); idx != sizeof( UIntType ); ++idx )
+      {
+         word = static_cast<UIntType>( ( word << 8 ) | src[idx] );
+      }
+      return word;
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Read count BIG_ENDIAN unsigned integers from unaligned memory.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void load_be( UIntType* dest, std::uint8_t const* src, std::size_t count )
+{
+   if constexpr( native_endianness == Endianness::LITTLE )
+   {
+      details::swapCopy<UIntType>( dest, src, count );
+   }
+   else if constexpr( native_endianness == Endianness::BIG )
+   {
+      std::memcpy( dest, src, count * sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( 0 ); idx != count; ++idx )
+      {
+         dest[idx] = load_be<UIntType>( src + idx * sizeof( UIntType ) );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write an unsigned integer to unaligned memory, BIG_ENDIAN.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void store_be( std::uint8_t* dest, UIntType val )
+{
+   static_assert( std::is_unsigned<UIntType>::value,
+                  "store_be writes unsigned integers only." );
+
+   if constexpr( native_endianness == Endianness::LITTLE ||
+                 native_endianness == Endianness::BIG )
+   {
+      UIntType const word( ( native_endianness == Endianness::LITTLE ) ? byte_swap( val ) : val );
+      std::memcpy( dest, &word, sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( sizeof( UIntType ) ); idx != 0; --idx, val >>= 8 )
+      {
+         dest[idx - 1] = static_cast<std::uint8_t>( val );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write count unsigned integers to unaligned memory, BIG_ENDIAN.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void store_be( std::uint8_t* dest, UIntType const* src, std::size_t count )
+{
+   if constexpr( native_endianness == Endianness::LITTLE )
+   {
+      details::swapCopy<UIntType>( dest, src, count );
+   }
+   else if constexpr( native_endianness == Endianness::BIG )
+   {
+      std::memcpy( dest, src, count * sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( 0 ); idx != count; ++idx )
+      {
+         store_be( dest + idx * sizeof( UIntType ), src[idx] );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE std::uint32_t load_be32( std::uint8_t const* src )
+{
+   return load_be<std::uint32_t>( src );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE std::uint64_t load_be64( std::uint8_t const* src )
+{
+   return load_be<std::uint64_t>( src );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE void store_be32( std::uint8_t* dest, std::uint32_t val )
+{
+   store_be( dest, val );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE void store_be64( std::uint8_t* dest, std::uint64_t val )
+{
+   store_be( dest, val );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Read a LITTLE_ENDIAN unsigned integer from unaligned memory.
+ *
+ *  A plain load on little endian targets.
+ */
+template< typename UIntType >
+ALWAYS_INLINE UIntType load_le( std::uint8_t const* src )
+{
+   static_assert( std::is_unsigned<UIntType>::value,
+                  "load_le reads unsigned integers only." );
+
+   if constexpr( native_endianness == Endianness::LITTLE ||
+                 native_endianness == Endianness::BIG )
+   {
+      UIntType word;
+      std::memcpy( &word, src, sizeof( UIntType ) );
+      return ( native_endianness == Endianness::BIG ) ? byte_swap( word ) : word;
+   }
+   else
+   {
+      UIntType word( 0 );
+      for( std::size_t idx( sizeof( UIntType ) ); idx != 0; --idx )
+      {
+         word = static_cast<UIntType>( ( word << 8 ) | src[idx - 1] );
+      }
+      return word;
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Read count LITTLE_ENDIAN unsigned integers from unaligned memory.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void load_le( UIntType* dest, std::uint8_t const* src, std::size_t count )
+{
+   if constexpr( native_endianness == Endianness::LITTLE )
+   {
+      std::memcpy( dest, src, count * sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( 0 ); idx != count; ++idx )
+      {
+         dest[idx] = load_le<UIntType>( src + idx * sizeof( UIntType ) );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write an unsigned integer to unaligned memory, LITTLE_ENDIAN.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void store_le( std::uint8_t* dest, UIntType val )
+{
+   static_assert( std::is_unsigned<UIntType>::value,
+                  "store_le writes unsigned integers only." );
+
+   if constexpr( native_endianness == Endianness::LITTLE ||
+                 native_endianness == Endianness::BIG )
+   {
+      UIntType const word( ( native_endianness == Endianness::BIG ) ? byte_swap( val ) : val );
+      std::memcpy( dest, &word, sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( 0 ); idx != sizeof( UIntType ); ++idx, val >>= 8 )
+      {
+         dest[idx] = static_cast<std::uint8_t>( val );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write count unsigned integers to unaligned memory, LITTLE_ENDIAN.
+ */
+template< typename UIntType >
+ALWAYS_INLINE void store_le( std::uint8_t* dest, UIntType const* src, std::size_t count )
+{
+   if constexpr( native_endianness == Endianness::LITTLE )
+   {
+      std::memcpy( dest, src, count * sizeof( UIntType ) );
+   }
+   else
+   {
+      for( std::size_t idx( 0 ); idx != count; ++idx )
+      {
+         store_le( dest + idx * sizeof( UIntType ), src[idx] );
+      }
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE std::uint32_t load_le32( std::uint8_t const* src )
+{
+   return load_le<std::uint32_t>( src );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE std::uint64_t load_le64( std::uint8_t const* src )
+{
+   return load_le<std::uint64_t>( src );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE void store_le32( std::uint8_t* dest, std::uint32_t val )
+{
+   store_le( dest, val );
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE void store_le64( std::uint8_t* dest, std::uint64_t val )
+{
+   store_le( dest, val );
 }
 
 
@@ -209,7 +535,7 @@ byte_swap<std::uint64_t>( std::uint64_t const& x )
  *         moves.
  */
 template< typename IntType >
-ALWAYS_INLINE IntType
+ALWAYS_INLINE constexpr IntType
 bit_rotate_lt( IntType const& val, std::uint_fast16_t moves )
 {
    static_assert( std::is_integral< IntType >::value,
@@ -226,7 +552,7 @@ bit_rotate_lt( IntType const& val, std::uint_fast16_t moves )
  *         moves.
  */
 template< typename IntType >
-ALWAYS_INLINE IntType
+ALWAYS_INLINE constexpr IntType
 bit_rotate_rt( IntType const& val, std::uint_fast16_t moves )
 {
    static_assert( std::is_integral< IntType >::value,
@@ -301,88 +627,229 @@ setNthBit( IntType const& val, std::uint_fast16_t n )
 
 
 
+namespace details
+{
+
 //------------------------------------------------------------------------------
 /*!
- *  Input should be LITTLE_ENDIAN.  Output is BIG_ENDIAN so as to be human
- *  readable and does NOT have the 0x prefix.
+ *  @brief The two hex characters of every byte value.
  */
-template<>
-inline std::string to_hex<std::uint8_t>( std::uint8_t nb )
+constexpr std::array< char, 512 > makeHexPairs()
 {
-   std::string strg( "00" );
-   strg[0] = hex_digits[ (nb & 0xf0) >> 4 ];
-   strg[1] = hex_digits[ (nb & 0x0f) ];
-   return strg;
+   std::array< char, 512 > pairs{};
+   for( std::size_t byte( 0 ); byte != 256; ++byte )
+   {
+      pairs[2 * byte] = hex_digits[byte >> 4];
+      pairs[2 * byte + 1] = hex_digits[byte & 0x0f];
+   }
+   return pairs;
 }
 
+constexpr std::array< char, 512 > hex_pairs = makeHexPairs();
+
 
 
 //------------------------------------------------------------------------------
 /*!
- *  Input should be LITTLE_ENDIAN.  Output is BIG_ENDIAN so as to be human
- *  readable and does NOT have the 0x prefix.
+ *  @brief Value of every hex character, 0xff for the other characters.
+ *
+ *  Both cases are accepted.
  */
-template<>
-inline std::string to_hex<std::uint16_t>( std::uint16_t nb )
+constexpr std::array< std::uint8_t, 256 > makeHexValues()
 {
-   std::string strg( "0000" );
-   strg[0] = hex_digits[ (nb & 0xf000) >> 12 ];
-   strg[1] = hex_digits[ (nb & 0x0f00) >>  8 ];
-   strg[2] = hex_digits[ (nb & 0x00f0) >>  4 ];
-   strg[3] = hex_digits[ (nb & 0x000f) ];
-   return strg;
+   std::array< std::uint8_t, 256 > values{};
+   for( std::size_t chr( 0 ); chr != 256; ++chr )
+   {
+      values[chr] = ( chr >= '0' && chr <= '9' ) ? chr - '0' :
+                    ( chr >= 'a' && chr <= 'f' ) ? chr - 'a' + 10 :
+                    ( chr >= 'A' && chr <= 'F' ) ? chr - 'A' + 10 : 0xff;
+   }
+   return values;
 }
 
+constexpr std::array< std::uint8_t, 256 > hex_values = makeHexValues();
+
 
 
 //------------------------------------------------------------------------------
 /*!
- *  Input should be LITTLE_ENDIAN.  Output is BIG_ENDIAN so as to be human
- *  readable and does NOT have the 0x prefix.
+ *  @brief Hex encoding with a lookup of two characters per byte.
  */
-template<>
-inline std::string to_hex<std::uint32_t>( std::uint32_t nb )
-{
-   std::string strg( "00000000" );
-   strg[0] = hex_digits[ (nb & 0xf0000000) >> 28 ];
-   strg[1] = hex_digits[ (nb & 0x0f000000) >> 24 ];
-   strg[2] = hex_digits[ (nb & 0x00f00000) >> 20 ];
-   strg[3] = hex_digits[ (nb & 0x000f0000) >> 16 ];
-   strg[4] = hex_digits[ (nb & 0x0000f000) >> 12 ];
-   strg[5] = hex_digits[ (nb & 0x00000f00) >>  8 ];
-   strg[6] = hex_digits[ (nb & 0x000000f0) >>  4 ];
-   strg[7] = hex_digits[ (nb & 0x0000000f) ];
-   return strg;
+inline char* toHexTable( std::uint8_t const* bytes, std::size_t len, char* out )
+{
+   for( ; len != 0; --len, ++bytes, out += 2 )
+   {
+      out[0] = hex_pairs[2 * *bytes];
+      out[1] = hex_pairs[2 * *bytes + 1];
+   }
+   return out;
 }
 
 
 
+#if HDQRT_X86_BACKENDS
 //------------------------------------------------------------------------------
 /*!
+ *  @brief Hex encoding of 16 bytes per iteration with SSSE3.
+ *
+ *  The nibbles index hex_digits with a byte shuffle and are interleaved back
+ *  into high, low order.  The tail goes through the table.
+ */
+HDQRT_TARGET( "ssse3" )
+inline char* toHexSsse3( std::uint8_t const* bytes, std::size_t len, char* out )
+{
+   __m128i const digits( _mm_loadu_si128( reinterpret_cast< __m128i const* >( hex_digits ) ) );
+   __m128i const lowNibbles( _mm_set1_epi8( 0x0f ) );
+
+   for( ; len >= 16; len -= 16, bytes += 16, out += 32 )
+   {
+      __m128i x( _mm_loadu_si128( reinterpret_cast< __m128i const* >( bytes ) ) );
+      __m128i hi( _mm_shuffle_epi8( digits, _mm_and_si128( _mm_srli_epi16( x, 4 ), lowNibbles ) ) );
+      __m128i lo( _mm_shuffle_epi8( digits, _mm_and_si128( x, lowNibbles ) ) );
+      _mm_storeu_si128( reinterpret_cast< __m128i* >( out ), _mm_unpacklo_epi8( hi, lo ) );
+      _mm_storeu_si128( reinterpret_cast< __m128i* >( out + 16 ), _mm_unpackhi_epi8( hi, lo ) );
+   }
+   return toHexTable( bytes, len, out );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hex encoding of 32 bytes per iteration with AVX2.
+ *
+ *  Same as toHexSsse3, but the interleave works within each 128 bits lane, so
+ *  the halves are put back in order before the stores.
+ */
+HDQRT_TARGET( "avx2" )
+inline char* toHexAvx2( std::uint8_t const* bytes, std::size_t len, char* out )
+{
+   __m256i const digits( _mm256_broadcastsi128_si256(
+               _mm_loadu_si128( reinterpret_cast< __m128i const* >( hex_digits ) ) ) );
+   __m256i const lowNibbles( _mm256_set1_epi8( 0x0f ) );
+
+   for( ; len >= 32; len -= 32, bytes += 32, out += 64 )
+   {
+      __m256i x( _mm256_loadu_si256( reinterpret_cast< __m256i const* >( bytes ) ) );
+      __m256i hi( _mm256_shuffle_epi8( digits,
+                     _mm256_and_si256( _mm256_srli_epi16( x, 4 ), lowNibbles ) ) );
+      __m256i lo( _mm256_shuffle_epi8( digits, _mm256_and_si256( x, lowNibbles ) ) );
+      __m256i first( _mm256_unpacklo_epi8( hi, lo ) );   // bytes 0-7, 16-23
+      __m256i second( _mm256_unpackhi_epi8( hi, lo ) );  // bytes 8-15, 24-31
+      _mm256_storeu_si256( reinterpret_cast< __m256i* >( out ),
+                           _mm256_permute2x128_si256( first, second, 0x20 ) );
+      _mm256_storeu_si256( reinterpret_cast< __m256i* >( out + 32 ),
+                           _mm256_permute2x128_si256( first, second, 0x31 ) );
+   }
+   return toHexSsse3( bytes, len, out );
+}
+#endif
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hex representation of an unsigned integer.
+ *
  *  Input should be LITTLE_ENDIAN.  Output is BIG_ENDIAN so as to be human
  *  readable and does NOT have the 0x prefix.
  */
-template<>
-inline std::string to_hex<std::uint64_t>( std::uint64_t nb )
-{
-   std::string strg( "0000000000000000" );
-   strg[0] =  hex_digits[ (nb & 0xf000000000000000) >> 60 ];
-   strg[1] =  hex_digits[ (nb & 0x0f00000000000000) >> 56 ];
-   strg[2] =  hex_digits[ (nb & 0x00f0000000000000) >> 52 ];
-   strg[3] =  hex_digits[ (nb & 0x000f000000000000) >> 48 ];
-   strg[4] =  hex_digits[ (nb & 0x0000f00000000000) >> 44 ];
-   strg[5] =  hex_digits[ (nb & 0x00000f0000000000) >> 40 ];
-   strg[6] =  hex_digits[ (nb & 0x000000f000000000) >> 36 ];
-   strg[7] =  hex_digits[ (nb & 0x0000000f00000000) >> 32];
-   strg[8] =  hex_digits[ (nb & 0x00000000f0000000) >> 28 ];
-   strg[9] =  hex_digits[ (nb & 0x000000000f000000) >> 24 ];
-   strg[10] = hex_digits[ (nb & 0x0000000000f00000) >> 20 ];
-   strg[11] = hex_digits[ (nb & 0x00000000000f0000) >> 16 ];
-   strg[12] = hex_digits[ (nb & 0x000000000000f000) >> 12 ];
-   strg[13] = hex_digits[ (nb & 0x0000000000000f00) >>  8 ];
-   strg[14] = hex_digits[ (nb & 0x00000000000000f0) >>  4 ];
-   strg[15] = hex_digits[ (nb & 0x000000000000000f) ];
+template<typename UIntType>
+inline std::string to_hex( UIntType nb )
+{
+   std::string strg( 2 * sizeof( UIntType ), '0' );
+   to_hex( nb, &strg[0] );
    return strg;
 }
 
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write the hex representation of an unsigned integer to out.
+ *
+ *  Writes 2 * sizeof( UIntType ) characters, most significant first, without
+ *  the 0x prefix nor a terminating null.  Returns the end of the output.
+ */
+template<typename UIntType>
+ALWAYS_INLINE char* to_hex( UIntType nb, char* out )
+{
+   static_assert( std::is_unsigned<UIntType>::value,
+                  "Hex representation of unsigned integers only." );
+
+   for( std::size_t idx( sizeof( UIntType ) ); idx != 0; --idx, out += 2 )
+   {
+      std::uint8_t const byte( static_cast< std::uint8_t >( nb >> ( 8 * ( idx - 1 ) ) ) );
+      out[0] = details::hex_pairs[2 * byte];
+      out[1] = details::hex_pairs[2 * byte + 1];
+   }
+   return out;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write the lowercase hex representation of len bytes to out.
+ *
+ *  Writes 2 * len characters, without a terminating null, and returns the end
+ *  of the output.  Uses AVX2 or SSSE3 when the CPU supports them.  AVX2 only
+ *  pays off from 128 bytes : below, its cross lane permutes cost more than
+ *  the wider stores save.
+ */
+inline char* to_hex( std::uint8_t const* bytes, std::size_t len, char* out )
+{
+#if HDQRT_X86_BACKENDS
+   if( len >= 128 && cpu::hasAvx2() )
+   {
+      return details::toHexAvx2( bytes, len, out );
+   }
+   if( len >= 16 && cpu::hasSsse3() )
+   {
+      return details::toHexSsse3( bytes, len, out );
+   }
+#endif
+   return details::toHexTable( bytes, len, out );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Decode len hex characters to len / 2 bytes in out.
+ *
+ *  Accepts both cases.  Returns false if len is odd or a character is not a
+ *  hex digit, in which case the content of out is unspecified.  Usable in
+ *  constant expressions.
+ */
+constexpr bool from_hex( char const* hex, std::size_t len, std::uint8_t* out )
+{
+   if( len % 2 != 0 ) { return false; }
+
+   // Invalid characters map to 0xff : checking once at the end keeps the
+   // loop free of branches
+   std::uint8_t invalid( 0 );
+   for( ; len != 0; len -= 2, hex += 2, ++out )
+   {
+      std::uint8_t const hi( details::hex_values[static_cast< unsigned char >( hex[0] )] );
+      std::uint8_t const lo( details::hex_values[static_cast< unsigned char >( hex[1] )] );
+      invalid |= hi | lo;
+      *out = static_cast< std::uint8_t >( ( hi << 4 ) | ( lo & 0x0f ) );
+   }
+   return ( invalid & 0x80 ) == 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Decode a hex string to hex.size() / 2 bytes in out.
+ */
+constexpr bool from_hex( std::string_view hex, std::uint8_t* out )
+{
+   return from_hex( hex.data(), hex.size(), out );
+}
+
 } // namespace bits
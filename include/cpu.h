@@ -0,0 +1,57 @@
+#ifndef HDQRT_GENERAL_CPU_H_
+#define HDQRT_GENERAL_CPU_H_
+
+
+//------------------------------------------------------------------------------
+// x86 backends need GCC or Clang for the per function target attribute and
+// <cpuid.h>.  Other compilers and architectures only get the portable code.
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( defined( __GNUC__ ) || defined( __clang__ ) )
+#  define HDQRT_X86_BACKENDS 1
+#  define HDQRT_TARGET( isa ) __attribute__(( target( isa ) ))
+#else
+#  define HDQRT_X86_BACKENDS 0
+#  define HDQRT_TARGET( isa )
+#endif
+
+
+namespace cpu
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Instruction set extensions the hash backends can use.
+ */
+struct Features
+{
+   bool ssse3;
+   bool sse42;
+   bool avx2;
+   bool bmi2;
+   bool shaNi;
+};
+
+//------------------------------------------------------------------------------
+Features const& features();
+
+//------------------------------------------------------------------------------
+bool hasShaNi();
+
+//------------------------------------------------------------------------------
+bool hasAvx2();
+
+//------------------------------------------------------------------------------
+bool hasSsse3();
+
+//------------------------------------------------------------------------------
+bool hasSse42();
+
+//------------------------------------------------------------------------------
+bool hasBmi2();
+
+
+} // namespace cpu
+
+#include "cpu.inl"
+
+#endif // HDQRT_GENERAL_CPU_H_
@@ -0,0 +1,127 @@
+#if HDQRT_X86_BACKENDS
+#  include <cpuid.h>
+#endif
+
+
+namespace cpu
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Query CPUID, and XCR0 for the register states saved by the OS.
+ *
+ *  Only reports an extension when everything its backend needs is there :
+ *  SHA-NI comes with SSE4.1 and SSSE3, BMI2 with BMI1, AVX2 needs the OS to
+ *  save the YMM registers.
+ */
+inline Features probe()
+{
+   Features found = { false, false, false, false, false };
+
+#if HDQRT_X86_BACKENDS
+   unsigned int eax( 0 ), ebx( 0 ), ecx( 0 ), edx( 0 );
+
+   // Leaf 1, ecx : SSSE3 is bit 9, SSE4.1 is bit 19, SSE4.2 is bit 20,
+   //               OSXSAVE is bit 27, AVX is bit 28
+   if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) ) { return found; }
+   bool const sse41( ( ecx & ( 1u << 19 ) ) != 0 );
+   bool const osxsave( ( ecx & ( 1u << 27 ) ) != 0 );
+   bool const avx( ( ecx & ( 1u << 28 ) ) != 0 );
+   found.ssse3 = ( ecx & ( 1u << 9 ) ) != 0;
+   found.sse42 = ( ecx & ( 1u << 20 ) ) != 0;
+
+   // XCR0 : the OS must save both the XMM (bit 1) and YMM (bit 2) states
+   bool ymmSaved( false );
+   if( osxsave )
+   {
+      unsigned int xcr0Low( 0 ), xcr0High( 0 );
+      __asm__( "xgetbv" : "=a"( xcr0Low ), "=d"( xcr0High ) : "c"( 0 ) );
+      ymmSaved = ( xcr0Low & 0x6 ) == 0x6;
+   }
+
+   // Leaf 7, sub-leaf 0, ebx : BMI1 is bit 3, AVX2 is bit 5, BMI2 is bit 8,
+   //                          SHA is bit 29
+   if( !__get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) ) { return found; }
+   found.avx2 = avx && ymmSaved && ( ebx & ( 1u << 5 ) );
+   found.bmi2 = ( ebx & ( 1u << 3 ) ) && ( ebx & ( 1u << 8 ) );
+   found.shaNi = found.ssse3 && sse41 && ( ebx & ( 1u << 29 ) );
+#endif
+
+   return found;
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Extensions supported by the CPU this process runs on.
+ *
+ *  CPUID is queried on the first call only.
+ */
+inline Features const& features()
+{
+   static Features const probed( details::probe() );
+   return probed;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether the CPU supports the Intel SHA extensions (SHA-NI).
+ */
+inline bool hasShaNi()
+{
+   return features().shaNi;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether the CPU and the OS support AVX2.
+ */
+inline bool hasAvx2()
+{
+   return features().avx2;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether the CPU supports SSSE3.
+ */
+inline bool hasSsse3()
+{
+   return features().ssse3;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether the CPU supports SSE4.2.
+ */
+inline bool hasSse42()
+{
+   return features().sse42;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether the CPU supports BMI1 and BMI2 (andn, rorx).
+ */
+inline bool hasBmi2()
+{
+   return features().bmi2;
+}
+
+} // namespace cpu
@@ -5,6 +5,10 @@
 #include <limits>
 #include <array>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef> // for std::byte
+#include <climits> // for CHAR_BIT
 #include <type_traits>
 
 #include <chrono>
@@ -12,27 +16,48 @@
 
 #include "bits.h"
 #include "hashes/hash_list.h"
+#include "hashes/Digest.h"
 
 namespace hashes
 {
 
 
 //------------------------------------------------------------------------------
+/*!
+ *  @brief Chaining state of a message being hashed.
+ *
+ *  As many words as initial values : 4 for MD5, 5 for SHA1, 8 for SHA2.
+ */
 template< typename Algo >
 struct Hash
 {
    typedef typename Algo::word_t word_t;
-   typedef typename std::array< word_t, Algo::nb_of_sha_vars > hash_type;
+   typedef typename std::array< word_t, Algo::initHashVals.size() > hash_type;
    hash_type state;
 };
 
 
 
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Stack buffer holding the padded end of a message.
+ *
+ *  Padding never needs more than two chunks.
+ */
+template< typename Algo >
+using LastChunks = std::array< std::uint8_t, 2 * Algo::chunk_size / CHAR_BIT >;
+
+
+
+template< typename Algo >
+void addBigEndianRep( std::uint8_t* dest, std::uint64_t msgLenInBytes );
+
 template< typename Algo >
-void addBigEndianRep( std::string& msg, std::uint64_t& len );
+void addLittleEndianRep( std::uint8_t* dest, std::uint64_t msgLenInBytes );
 
 template< typename Algo >
-void padLastChunk( std::string& msg, std::size_t origMsgLen );
+std::size_t padLastChunk( LastChunks<Algo>& dest, std::uint8_t const* tail,
+                          std::size_t tailLen, std::uint64_t origMsgLen );
 
 template<typename Algo>
 void initializeHash( Hash<Algo>& theHash );
@@ -41,20 +66,114 @@ template< typename Algo >
 void applyRounds( typename Hash<Algo>::hash_type& theHash,
                   std::array< typename Algo::word_t, Algo::rounds >  const& W );
 
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Implementations of the chunk processing, selected at runtime.
+ *
+ *  AVX2 only has a multi-buffer kernel, used by hashBatch.
+ */
+enum class Backend : std::uint_fast8_t
+{
+   SCALAR,
+   BMI2,
+   SSSE3,
+   SHA_NI,
+   AVX2
+};
+
+template< typename Algo >
+using blocks_fn = void (*)( typename Hash<Algo>::hash_type& state,
+                            std::uint8_t const* blocks, std::size_t nbOfBlocks );
+
+template< typename Algo >
+using zero_blocks_fn = void (*)( typename Hash<Algo>::hash_type& state,
+                                 std::uint64_t nbOfBlocks );
+
+char const* backendName( Backend backend );
+
+bool backendFromName( char const* name, Backend& backend );
+
+template< typename Algo >
+blocks_fn<Algo> backendBlocks( Backend backend );
+
+template< typename Algo >
+zero_blocks_fn<Algo> backendZeroBlocks( Backend backend );
+
+template< typename Algo >
+Backend selectedBackend();
+
+template< typename Algo >
+Backend batchBackend();
+
+template< typename Algo >
+bool selfTest();
+
+bool selfTest();
+
+
+
+template< typename Algo >
+void processBlocks( typename Hash<Algo>::hash_type& state,
+                    std::uint8_t const* blocks, std::size_t nbOfBlocks );
+
+template< typename Algo >
+void processZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks );
+
 template< typename Algo >
-void processChunk( typename Hash<Algo>::hash_type& theHash, std::string const& chunk );
+void processChunk( Hash<Algo>& theHash, std::uint8_t const* chunk );
+
 
 
 template< typename Algo >
 typename std::enable_if< std::is_base_of< HashBase, Algo >::value, std::string >::type
-getDigest( Hash<Algo>& theHash );
+getDigest( Hash<Algo> const& theHash );
+
+template< typename Algo >
+void getDigest( Hash<Algo> const& theHash, Digest<Algo>& digest );
+
+template< typename Algo >
+char* getDigest( Hash<Algo> const& theHash, char* out );
+
+template <typename Algo>
+std::string hashStrg( std::uint8_t const* input, std::size_t len );
+
+template <typename Algo>
+char* hashStrg( std::uint8_t const* input, std::size_t len, char* out );
+
+template <typename Algo>
+Digest<Algo> hashDigest( std::uint8_t const* input, std::size_t len );
+
+template <typename Algo>
+Digest<Algo> hashDigest( std::string_view input );
+
+template <typename Algo>
+std::string hashStrg( std::string_view input );
+
+template <typename Algo>
+std::string hashStrg( std::vector< std::uint8_t > const& input );
+
+template <typename Algo>
+std::string hashStrg( std::vector< std::byte > const& input );
+
+template <typename Algo, std::size_t N>
+std::string hashStrg( std::uint8_t const (&input)[N] );
 
 template <typename Algo>
-std::string hashStrg( std::string const& input );
+std::vector< std::string >
+hashBatch( std::vector< std::string_view > const& inputs );
 
 } // namespace hashes
 
 #include "hashes.inl"
+#include "hashes/Dispatch.inl"
+
+#include "hashes/Hasher.h"
+#include "hashes/Hmac.h"
+#include "hashes/Pbkdf2.h"
+#include "hashes/SHA256d.h"
+#include "hashes/CompileTime.h"
+#include "hashes/File.h"
+#include "hashes/FileBatch.h"
 
 #endif // HDQRT_HASH_HASHES_H_
 
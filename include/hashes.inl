@@ -1,58 +1,59 @@
 
 #include <sstream>
+#include <algorithm>
 #include <cstdio>
+#include <cstring> // for std::memcpy and std::memset
+#include <utility> // for std::index_sequence
 
 //#include "hashes.h"
 #include "always_inline.h"
+#include "cpu.h"
 
 namespace hashes
 {
 
 //------------------------------------------------------------------------------
 /*!
- *  @brief Add BIG_ENDIAN representation of the input len to the input message.
+ *  @brief Write the BIG_ENDIAN representation of a message length in bits.
+ *
+ *  Writes Algo::len_encode_len bits to dest.  The byte count is kept in 64
+ *  bits, so the bit count needs up to 67 bits.  With a 128 bits encoding (SHA512
+ *  family), the 3 high bits go in the upper half.  With a 64 bits encoding, the
+ *  length is taken modulo 2^64 as the standard requires.
  */
 template< typename Algo >
 ALWAYS_INLINE void
-addBigEndianRep( std::string& msg, std::uint64_t& len )
+addBigEndianRep( std::uint8_t* dest, std::uint64_t msgLenInBytes )
 {
-   // Add the size with most significant bit first, representation
+   constexpr std::size_t lenBytes( Algo::len_encode_len / CHAR_BIT );
+   constexpr std::size_t wordBytes( sizeof( std::uint64_t ) );
+   static_assert( lenBytes == wordBytes || lenBytes == 2 * wordBytes,
+                  "Length encoding must be 64 or 128 bits." );
+
+   bits::store_be64( dest + lenBytes - wordBytes, msgLenInBytes << 3 );
 
-   auto bytes = bits::unpack( len );
-   msg.push_back( bytes[0] );
-   msg.push_back( bytes[1] );
-   msg.push_back( bytes[2] );
-   msg.push_back( bytes[3] );
-   msg.push_back( bytes[4] );
-   msg.push_back( bytes[5] );
-   msg.push_back( bytes[6] );
-   msg.push_back( bytes[7] );
+   if( lenBytes == 2 * wordBytes )
+   {
+      bits::store_be64( dest, msgLenInBytes >> 61 );
+   }
 }
 
 
 
 //------------------------------------------------------------------------------
 /*!
- *  @brief Overload for SHA512 algorithm.
+ *  @brief Write the LITTLE_ENDIAN representation of a message length in bits.
  *
- *  Current implementation considers that the largest integer type is 64 bits.
- *  Thus, to write a 128 bits representation, 64 zero bits are added before
- *  adding the len representation.
+ *  MD5 only : 64 bits, the length taken modulo 2^64.
  */
-template<>
+template< typename Algo >
 ALWAYS_INLINE void
-addBigEndianRep<SHA512>( std::string& msg, std::uint64_t& len )
+addLittleEndianRep( std::uint8_t* dest, std::uint64_t msgLenInBytes )
 {
-   auto bytes = bits::unpack( len );
-   msg.append( 8, 0x0 );
-   msg.push_back( bytes[0] );
-   msg.push_back( bytes[1] );
-   msg.push_back( bytes[2] );
-   msg.push_back( bytes[3] );
-   msg.push_back( bytes[4] );
-   msg.push_back( bytes[5] );
-   msg.push_back( bytes[6] );
-   msg.push_back( bytes[7] );
+   static_assert( Algo::len_encode_len == 64,
+                  "Little endian length encoding must be 64 bits." );
+
+   bits::store_le64( dest, msgLenInBytes << 3 );
 }
 
 
@@ -62,43 +63,50 @@ addBigEndianRep<SHA512>( std::string& msg, std::uint64_t& len )
  *  @brief Pad last chunk before calculating final digest.
  *
  *  Default implementation does the following:
+ *    - copies the tail of the message (less than one chunk) to dest
  *    - adds 1 to message
- *    - pads message with zeros so that :
- *       Algo::chunk_size == last_chunk_len + Algo::len_encode_len + 1
- *    - appends the BIG_ENDIAN representation of the original length
+ *    - pads message with zeros so that the padded length plus
+ *      Algo::len_encode_len is a multiple of Algo::chunk_size
+ *    - appends the representation of the original length, in the byte order
+ *      of the algorithm (BIG_ENDIAN except for MD5)
  *
- *  Throws std::logic_error if system architecture does not appear to be 8-bit
- *  based.
+ *  When there is not enough room left in the tail for the 1 bit and the
+ *  length, the result spans two chunks.  Returns the number of chunks written.
  *
  */
 template< typename Algo >
-inline void
-padLastChunk( std::string& msg, std::uint64_t origMsgLen )
+inline std::size_t
+padLastChunk( LastChunks<Algo>& dest, std::uint8_t const* tail,
+              std::size_t tailLen, std::uint64_t origMsgLen )
 {
    // Guard
    static_assert( CHAR_BIT == 8, "System architecture for hashing support must "
                                  "be 8 bit based." );
 
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   constexpr std::size_t lenBytes( Algo::len_encode_len / CHAR_BIT );
 
-   using bits::binLength;
-   std::uint64_t msgLenInBits( binLength( msg[0] ) * origMsgLen );
-
-   unsigned int zerosToAdd( Algo::chunk_size - Algo::len_encode_len - 1 -
-                                       ( binLength( msg[0] ) * msg.length() ) );
-
-   // Prevent copies for reallocation by doing it in one swoop if necessary
-   msg.reserve( origMsgLen + 1 + zerosToAdd +
-                           ( bits::binLength<std::uint64_t>() / CHAR_BIT ) );
+   // Room needed after the data : the 0x80 byte and the length
+   std::size_t nbOfChunks( ( tailLen + 1 + lenBytes > chunkBytes ) ? 2 : 1 );
+   std::size_t paddedLen( nbOfChunks * chunkBytes );
 
+   if( tailLen != 0 ) { std::memcpy( dest.data(), tail, tailLen ); }
 
    // Add the 1 bit plus 7 zeros of padding.  Supposes char == 8 bits
-   msg.push_back( ( 1 << 7 ) );
-   zerosToAdd -= 7;
-   for( ; zerosToAdd != 0; zerosToAdd -=8 ) msg.push_back( 0 );
-
+   dest[tailLen] = ( 1 << 7 );
+   std::memset( dest.data() + tailLen + 1, 0, paddedLen - lenBytes - tailLen - 1 );
 
    // Add the length
-   addBigEndianRep<Algo>( msg, msgLenInBits );
+   if constexpr( Algo::byte_order == bits::Endianness::LITTLE )
+   {
+      addLittleEndianRep<Algo>( dest.data() + paddedLen - lenBytes, origMsgLen );
+   }
+   else
+   {
+      addBigEndianRep<Algo>( dest.data() + paddedLen - lenBytes, origMsgLen );
+   }
+
+   return nbOfChunks;
 }
 
 
@@ -114,32 +122,222 @@ initializeHash( Hash<Algo>& theHash )
 
 
 
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rounds of an algorithm without an implementation.  Does nothing.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+applyRounds( typename Hash<Algo>::hash_type&,
+             std::array< typename Algo::word_t, Algo::rounds > const&,
+             std::false_type )
+{}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rounds policy : runtime loop, the eight variables move every round.
+ *
+ *  Kept as the reference implementation and for benchmarking.
+ */
+struct LoopRounds
+{};
+
+
+
 //------------------------------------------------------------------------------
 /*!
- *  @brief Apply a round for a hashing algorithm.
+ *  @brief Rounds policy : rounds unrolled at compile time.
  *
- *  The default implementation does nothing.  Must be specialized for every
- *  algorithm.
+ *  Instead of moving the eight variables every round, the role of each
+ *  variable rotates from one round to the next, and K[idx] is a constant.
+ */
+struct UnrolledRounds
+{};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Schedule policy : all the words of W computed before the rounds.
  *
- *  Specialized implementations can (not mandatory, but usually) assume that the
- *  message chunck it gets is of correct bit size.
+ *  W holds Algo::rounds words (256 bytes for SHA256, 640 for SHA512).
+ */
+struct FullSchedule
+{};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Schedule policy : 16 word circular window, W[t] computed just in
+ *         time inside the rounds.
  *
+ *  W[t] only depends on W[t-16] to W[t-2], so the window holds 64 bytes
+ *  (SHA256) or 128 bytes (SHA512) instead of the whole schedule.
  */
+struct RollingSchedule
+{};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Schedule policy : the precomputed schedule of an all-zero chunk.
+ *
+ *  Every word of it is 0 (the sigma functions of 0 are 0), so nothing is
+ *  loaded nor expanded and the rounds only add K.  Used for the holes of
+ *  sparse files.
+ */
+struct ZeroSchedule
+{};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Storage for the message schedule of a schedule policy.
+ */
+template< typename Algo, typename Schedule >
+struct schedule_words;
+
 template< typename Algo >
-inline void
-applyRounds( typename Hash<Algo>::hash_type& theHash,
-            std::array< typename Algo::word_t, Algo::rounds > const& W )
-{}
+struct schedule_words< Algo, FullSchedule >
+{
+   typedef std::array< typename Algo::word_t, Algo::rounds > type;
+};
+
+template< typename Algo >
+struct schedule_words< Algo, RollingSchedule >
+{
+   typedef std::array< typename Algo::word_t, 16 > type;
+};
+
+template< typename Algo >
+struct schedule_words< Algo, ZeroSchedule >
+{
+   typedef std::array< typename Algo::word_t, 0 > type;
+};
 
 
 
 //------------------------------------------------------------------------------
-template<>
-inline void
-applyRounds<SHA256>( typename Hash<SHA256>::hash_type& theHash,
-                     std::array< typename SHA256::word_t, SHA256::rounds > const& W )
+/*!
+ *  @brief Compute the words 16 and up of the schedule from the first 16.
+ */
+template< typename Algo >
+ALWAYS_INLINE constexpr void
+expandSchedule( typename schedule_words< Algo, FullSchedule >::type& W )
+{
+   typedef typename Algo::family family;
+
+   for( std::uint_fast16_t idx( 16 ); idx != Algo::rounds; ++idx )
+   {
+      W[idx] = sigma1<family>( W[idx - 2] ) + W[idx - 7] +
+                                 sigma0<family>( W[idx - 15] ) + W[idx - 16];
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Load a chunk and compute its whole message schedule.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+prepareSchedule( typename schedule_words< Algo, FullSchedule >::type& W,
+                 std::uint8_t const* chunk, FullSchedule )
+{
+   bits::load_be( W.data(), chunk, 16 );
+   expandSchedule<Algo>( W );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Load a chunk in the 16 word window.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+prepareSchedule( typename schedule_words< Algo, RollingSchedule >::type& W,
+                 std::uint8_t const* chunk, RollingSchedule )
+{
+   bits::load_be( W.data(), chunk, 16 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Word idx of a schedule computed beforehand.
+ */
+template< typename Algo >
+ALWAYS_INLINE constexpr typename Algo::word_t
+scheduleWord( typename schedule_words< Algo, FullSchedule >::type const& W,
+              std::size_t idx, FullSchedule )
+{
+   return W[idx];
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Word idx of the schedule, computed in the 16 word window.
+ *
+ *  W[idx - 16] is overwritten, it is not needed anymore.
+ */
+template< typename Algo >
+ALWAYS_INLINE typename Algo::word_t
+scheduleWord( typename schedule_words< Algo, RollingSchedule >::type& W,
+              std::size_t idx, RollingSchedule )
+{
+   typedef typename Algo::family family;
+
+   if( idx >= 16 )
+   {
+      W[idx & 15] += sigma1<family>( W[( idx - 2 ) & 15] ) + W[( idx - 7 ) & 15] +
+                                    sigma0<family>( W[( idx - 15 ) & 15] );
+   }
+   return W[idx & 15];
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Word idx of the schedule of an all-zero chunk.
+ */
+template< typename Algo >
+ALWAYS_INLINE constexpr typename Algo::word_t
+scheduleWord( typename schedule_words< Algo, ZeroSchedule >::type const&,
+              std::size_t, ZeroSchedule )
+{
+   return 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rounds of the SHA2 family, as a runtime loop.
+ *
+ *  Shared by the 32 bits (SHA256, SHA224) and 64 bits (SHA512, SHA384,
+ *  SHA512/224, SHA512/256) members : the constants and sigma functions come
+ *  from the family, only the initial values and digest length differ.
+ */
+template< typename Algo, typename Schedule, typename Words >
+ALWAYS_INLINE constexpr void
+sha2Rounds( typename Hash<Algo>::hash_type& theHash, Words& W,
+            LoopRounds, Schedule )
 {
-   typedef SHA256 Algo;
+   typedef typename Algo::family family;
    typedef typename Algo::word_t word_t;
 
    word_t T1( 0 ), T2( 0 );
@@ -151,8 +349,9 @@ applyRounds<SHA256>( typename Hash<SHA256>::hash_type& theHash,
 
    for( std::uint_fast16_t idx( 0 ); idx != Algo::rounds; ++idx )
    {
-      T1 = h + Sigma1<Algo>( e ) + Ch( e, f, g ) + Algo::K[idx] + W[idx];
-      T2 = Sigma0<Algo>( a ) + Maj( a, b, c );
+      T1 = h + Sigma1<family>( e ) + Ch( e, f, g ) + family::K[idx] +
+                                    scheduleWord<Algo>( W, idx, Schedule() );
+      T2 = Sigma0<family>( a ) + Maj( a, b, c );
       h = g;
       g = f;
       f = e;
@@ -174,133 +373,769 @@ applyRounds<SHA256>( typename Hash<SHA256>::hash_type& theHash,
    theHash[7] += h;
 }
 
-template<>
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One SHA2 round with the roles of the variables renamed.
+ *
+ *  At round idx, variable a is vars[-idx mod 8], b is the next one and so on.
+ *  Only d and h are written : d becomes the new e and h the new a, which is
+ *  where the next round looks for them.  After a multiple of 8 rounds (64 or
+ *  80), every variable is back in its original place.
+ */
+template< typename Algo, typename Schedule, std::size_t idx, typename Words >
 ALWAYS_INLINE void
-applyRounds<SHA224>( typename Hash<SHA224>::hash_type& theHash,
-                     std::array< typename SHA224::word_t, SHA224::rounds > const& W )
+sha2Round( typename Hash<Algo>::hash_type& vars, Words& W )
 {
-   applyRounds<SHA256>( theHash, W );
+   typedef typename Algo::family family;
+   typedef typename Algo::word_t word_t;
+
+   constexpr std::size_t shift( 8 - idx % 8 );
+   constexpr word_t k( family::K[idx] );
+
+   word_t const& a( vars[( shift + 0 ) % 8] );
+   word_t const& b( vars[( shift + 1 ) % 8] );
+   word_t const& c( vars[( shift + 2 ) % 8] );
+   word_t&       d( vars[( shift + 3 ) % 8] );
+   word_t const& e( vars[( shift + 4 ) % 8] );
+   word_t const& f( vars[( shift + 5 ) % 8] );
+   word_t const& g( vars[( shift + 6 ) % 8] );
+   word_t&       h( vars[( shift + 7 ) % 8] );
+
+   word_t T1( h + Sigma1<family>( e ) + Ch( e, f, g ) + k +
+                                    scheduleWord<Algo>( W, idx, Schedule() ) );
+   d += T1;
+   h = T1 + Sigma0<family>( a ) + Maj( a, b, c );
 }
 
 
 
+//------------------------------------------------------------------------------
+template< typename Algo, typename Schedule, typename Words, std::size_t... idx >
+ALWAYS_INLINE void
+sha2Rounds( typename Hash<Algo>::hash_type& vars, Words& W,
+            std::index_sequence< idx... > )
+{
+   ( sha2Round< Algo, Schedule, idx >( vars, W ), ... );
+}
+
+
 
 //------------------------------------------------------------------------------
 /*!
- *  @brief Apply a round for a hashing algorithm.
- *
- *  The default implementation does nothing.  Must be specialized for every
- *  algorithm.
- *
- *  Specialized implementations can (not mandatory, but usually) assume that the
- *  message chunck it gets is of correct bit size.
- *
+ *  @brief Rounds of the SHA2 family, unrolled at compile time.
+ */
+template< typename Algo, typename Schedule, typename Words >
+ALWAYS_INLINE void
+sha2Rounds( typename Hash<Algo>::hash_type& theHash, Words& W,
+            UnrolledRounds, Schedule )
+{
+   static_assert( Algo::rounds % 8 == 0,
+                  "Renaming needs a multiple of 8 rounds to end in place." );
+
+   typename Hash<Algo>::hash_type vars( theHash );
+   sha2Rounds< Algo, Schedule >( vars, W,
+                                 std::make_index_sequence< Algo::rounds >() );
+
+   // Update the state
+   for( std::size_t idx( 0 ); idx != vars.size(); ++idx )
+   {
+      theHash[idx] += vars[idx];
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rounds of the SHA2 family.
  */
 template< typename Algo >
-inline void processChunk( Hash<Algo>& theHash, std::string const& chunck )
-{}
+ALWAYS_INLINE void
+applyRounds( typename Hash<Algo>::hash_type& theHash,
+             std::array< typename Algo::word_t, Algo::rounds > const& W,
+             std::true_type )
+{
+   sha2Rounds<Algo>( theHash, W, UnrolledRounds(), FullSchedule() );
+}
 
 
 
 //------------------------------------------------------------------------------
 /*!
- *  @brief Apply one round of the algorithm.
+ *  @brief Tag of the portable kernel of Algo, for processBlocks.
  *
- *  Assumes chunk is correct size.
+ *  std::true_type for the SHA2 family, std::false_type for an algorithm
+ *  without an implementation, the algorithm itself otherwise.
  */
+template< typename Algo >
+struct kernel_tag
+{
+   typedef is_sha2< Algo > type;
+};
+
 template<>
-inline void processChunk<SHA256>( Hash<SHA256>& theHash, std::string const& chunk )
+struct kernel_tag< MD5 >
 {
-   typedef SHA256 Algo;
-   typedef typename Algo::word_t word_t;
-   typedef std::uint_fast16_t uint_t;
-   using bits::pack;
-   using bits::byte_swap;
+   typedef MD5 type;
+};
 
-   // Create the 64 word work array W
-   std::array< word_t, Algo::rounds > W;
+template<>
+struct kernel_tag< SHA1 >
+{
+   typedef SHA1 type;
+};
 
-   for( std::size_t wordIdx( 0 ); wordIdx != 16; ++wordIdx )
-   {
-      auto charIdx = wordIdx * 4;
-      W[wordIdx] = pack( chunk[charIdx], chunk[charIdx+1],
-                                 chunk[charIdx+2], chunk[charIdx+3]  );
-   }
 
-   for( uint_t idx( 16 ); idx != Algo::rounds; ++idx )
-   {
-      W[idx] = sigma1<Algo>( W[idx - 2] ) + W[idx - 7] +
-                                    sigma0<Algo>( W[idx - 15] ) + W[idx - 16];
-   }
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of chunks with MD5.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+processBlocks( typename Hash<Algo>::hash_type& state,
+               std::uint8_t const* blocks, std::size_t nbOfBlocks, MD5 )
+{
+   md5Blocks( state, blocks, nbOfBlocks );
+}
 
 
-   // Apply the rounds
-   applyRounds<Algo>( theHash.state, W );
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of chunks with SHA1.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+processBlocks( typename Hash<Algo>::hash_type& state,
+               std::uint8_t const* blocks, std::size_t nbOfBlocks, SHA1 )
+{
+   sha1Blocks( state, blocks, nbOfBlocks );
 }
 
 
 
 //------------------------------------------------------------------------------
+/*!
+ *  @brief Chunks of an algorithm without an implementation.  Does nothing.
+ */
 template< typename Algo >
-inline typename std::enable_if< std::is_base_of< HashBase, Algo >::value, std::string >::type
-getDigest( Hash<Algo>& theHash )
+ALWAYS_INLINE void
+processBlocks( typename Hash<Algo>::hash_type&, std::uint8_t const*,
+               std::size_t, std::false_type )
+{}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of chunks with an algorithm of the SHA2 family.
+ *
+ *  Rounds is LoopRounds or UnrolledRounds, Schedule is FullSchedule or
+ *  RollingSchedule.  Always inlined so that each backend compiles it with its
+ *  own target instruction set.
+ */
+template< typename Algo, typename Rounds = UnrolledRounds,
+          typename Schedule = FullSchedule >
+ALWAYS_INLINE void
+processBlocks( typename Hash<Algo>::hash_type& state,
+               std::uint8_t const* blocks, std::size_t nbOfBlocks,
+               std::true_type )
 {
-   using bits::Endianness;
-   using bits::endianness;
-   using bits::byte_swap;
-   using bits::to_hex;
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
 
-   // Create string object to hold digest.  Reserve appropriate length.
-   std::string digest( "" );
-   digest.reserve( Algo::digest_len );
+   // Local copy of the state : the rounds are inlined, so it is kept in
+   // registers for the whole run instead of going back to memory every chunk
+   typename Hash<Algo>::hash_type vars( state );
 
-   for( typename Hash<Algo>::word_t const& cur : theHash.state )
+   typename schedule_words< Algo, Schedule >::type W;
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += chunkBytes )
    {
-      digest.append( to_hex( cur ) );
+      prepareSchedule<Algo>( W, blocks, Schedule() );
+
+      // Apply the rounds
+      sha2Rounds<Algo>( vars, W, Rounds(), Schedule() );
    }
 
-   return digest;
+   state = vars;
 }
 
 
 
+
 //------------------------------------------------------------------------------
 /*!
- *  @brief Hash a string with the given algorithm.
+ *  @brief Process a run of all-zero chunks with an algorithm of the SHA2
+ *         family : only the rounds run, see ZeroSchedule.
  */
-template <typename Algo>
-inline std::string hashStrg( std::string const& input )
+template< typename Algo, typename Rounds = UnrolledRounds >
+ALWAYS_INLINE void
+processZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks,
+                   std::true_type )
 {
-   // Sanity check
-   auto elemBinLength = bits::binLength( input[0] );
-   if( Algo::chunk_size % elemBinLength != 0 )
+   typename Hash<Algo>::hash_type vars( state );
+   typename schedule_words< Algo, ZeroSchedule >::type const W{};
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks )
    {
-      throw std::logic_error( "Size do not match. byte != 8 bits" );
+      sha2Rounds<Algo>( vars, W, Rounds(), ZeroSchedule() );
    }
 
+   state = vars;
+}
+
 
-   Hash<Algo> theHash;
-   initializeHash<Algo>( theHash );
 
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of all-zero chunks through the selected kernel,
+ *         reading them from a static buffer of zeros.
+ */
+template< typename Algo >
+inline void
+zeroBlocksFromBuffer( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   constexpr std::size_t bufferBlocks( 64 );
+   static std::array< std::uint8_t, bufferBlocks * chunkBytes > const zeros{};
 
-   auto chunkStart( input.begin() );
-   auto elemsPerChunk = Algo::chunk_size / elemBinLength;
-   auto chunkEnd( chunkStart + elemsPerChunk );
-   auto origEnd( input.end() );
-   while( chunkEnd < origEnd )
+   while( nbOfBlocks != 0 )
    {
-      processChunk<Algo>( theHash, std::string( chunkStart, chunkEnd ) );
-      chunkStart = chunkEnd;
-      chunkEnd += elemsPerChunk;
+      std::size_t const run( static_cast< std::size_t >(
+                                std::min< std::uint64_t >( nbOfBlocks, bufferBlocks ) ) );
+      hashes::processBlocks<Algo>( state, zeros.data(), run );
+      nbOfBlocks -= run;
    }
+}
+
 
 
-   auto lastChunk = std::string( chunkStart, input.end() );
-   padLastChunk<Algo>( lastChunk, static_cast<std::uint64_t>( input.length() ) );
-   processChunk<Algo>( theHash, lastChunk );
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of all-zero chunks with MD5.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+processZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks, MD5 )
+{
+   zeroBlocksFromBuffer<Algo>( state, nbOfBlocks );
+}
 
 
-   return getDigest<Algo>( theHash );
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of all-zero chunks with SHA1.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+processZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks, SHA1 )
+{
+   zeroBlocksFromBuffer<Algo>( state, nbOfBlocks );
 }
 
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Zero chunks of an algorithm without an implementation.  Does
+ *         nothing.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+processZeroBlocks( typename Hash<Algo>::hash_type&, std::uint64_t, std::false_type )
+{}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Apply the rounds of a hashing algorithm to one chunk.
+ *
+ *  Implemented for the SHA2 family.  Other algorithms do nothing unless
+ *  specialized.
+ *
+ *  Specialized implementations can (not mandatory, but usually) assume that the
+ *  message chunck it gets is of correct bit size.
+ *
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+applyRounds( typename Hash<Algo>::hash_type& theHash,
+            std::array< typename Algo::word_t, Algo::rounds > const& W )
+{
+   details::applyRounds<Algo>( theHash, W, is_sha2< Algo >() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of contiguous chunks of a message.
+ *
+ *  Implemented for MD5, SHA1 and the SHA2 family.  Other algorithms do
+ *  nothing unless specialized.  This is the compression kernel every backend plugs in
+ *  behind : the loop over the chunks lives inside it so that the state can
+ *  stay in registers from one chunk to the next.
+ *
+ *  The backend is bound on the first call, see selectedBackend.
+ *
+ *  The input must point to nbOfBlocks * Algo::chunk_size bits of readable
+ *  memory.
+ *
+ */
+template< typename Algo >
+inline void
+processBlocks( typename Hash<Algo>::hash_type& state,
+               std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   static blocks_fn<Algo> const selected( backendBlocks<Algo>( selectedBackend<Algo>() ) );
+   selected( state, blocks, nbOfBlocks );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process a run of chunks made only of zeros, without reading them.
+ *
+ *  Same result as processBlocks on nbOfBlocks * Algo::chunk_size bits of
+ *  zeros.  The SHA2 family skips the message schedule, which is known in
+ *  advance; other algorithms go through processBlocks.  The kernel is bound
+ *  on the first call, for the backend processBlocks uses.
+ */
+template< typename Algo >
+inline void
+processZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks )
+{
+   static zero_blocks_fn<Algo> const selected( backendZeroBlocks<Algo>( selectedBackend<Algo>() ) );
+   selected( state, nbOfBlocks );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Process one chunk of a message.
+ *
+ *  The chunk must point to Algo::chunk_size bits of readable memory.
+ *
+ */
+template< typename Algo >
+ALWAYS_INLINE void processChunk( Hash<Algo>& theHash, std::uint8_t const* chunk )
+{
+   processBlocks<Algo>( theHash.state, chunk, 1 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write count words of a state in the byte order of Algo.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+storeWords( std::uint8_t* dest, typename Algo::word_t const* src, std::size_t count )
+{
+   if constexpr( Algo::byte_order == bits::Endianness::LITTLE )
+   {
+      bits::store_le( dest, src, count );
+   }
+   else
+   {
+      bits::store_be( dest, src, count );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Binary digest of a final state.
+ *
+ *  The words are written in the byte order of Algo : big endian except for
+ *  MD5.  Truncated variants (SHA224, SHA384, SHA512/t) keep the leftmost
+ *  digest_len bits.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+getDigest( Hash<Algo> const& theHash, Digest<Algo>& digest )
+{
+   typedef typename Hash<Algo>::word_t word_t;
+   constexpr std::size_t wholeWords( Digest<Algo>::size / sizeof( word_t ) );
+   constexpr std::size_t tailBytes( Digest<Algo>::size % sizeof( word_t ) );
+
+   storeWords<Algo>( digest.bytes.data(), theHash.state.data(), wholeWords );
+   if( tailBytes != 0 )
+   {
+      // SHA512/224 : half of the fourth word
+      std::uint8_t last[sizeof( word_t )];
+      storeWords<Algo>( last, theHash.state.data() + wholeWords, 1 );
+      std::memcpy( digest.bytes.data() + wholeWords * sizeof( word_t ), last, tailBytes );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write the hex digest of a final state to out.
+ *
+ *  Writes Digest<Algo>::hex_size characters, without a terminating null, and
+ *  returns the end of the output.  Does not allocate.
+ */
+template< typename Algo >
+inline char*
+getDigest( Hash<Algo> const& theHash, char* out )
+{
+   Digest<Algo> digest;
+   getDigest( theHash, digest );
+   return digest.toHex( out );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hex digest of a final state.
+ */
+template< typename Algo >
+inline typename std::enable_if< std::is_base_of< HashBase, Algo >::value, std::string >::type
+getDigest( Hash<Algo> const& theHash )
+{
+   Digest<Algo> digest;
+   getDigest( theHash, digest );
+   return digest.hex();
+}
+
+
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Final state of a message.
+ *
+ *  Chunks are read straight from the input memory.  Only the padded tail is
+ *  copied, to a buffer on the stack.
+ */
+template <typename Algo>
+inline void
+hashMessage( Hash<Algo>& theHash, std::uint8_t const* input, std::size_t len )
+{
+   static_assert( Algo::chunk_size % CHAR_BIT == 0,
+                  "Chunk size must be a whole number of bytes." );
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+
+
+   initializeHash<Algo>( theHash );
+
+
+   std::size_t nbOfChunks( len / chunkBytes );
+   hashes::processBlocks<Algo>( theHash.state, input, nbOfChunks );
+
+
+   // The padded tail is one or two chunks long
+   LastChunks<Algo> lastChunks;
+   std::size_t tailStart( nbOfChunks * chunkBytes );
+   nbOfChunks = padLastChunk<Algo>( lastChunks, input + tailStart,
+                                    len - tailStart,
+                                    static_cast<std::uint64_t>( len ) );
+   hashes::processBlocks<Algo>( theHash.state, lastChunks.data(), nbOfChunks );
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a message with the given algorithm.
+ */
+template <typename Algo>
+inline std::string hashStrg( std::uint8_t const* input, std::size_t len )
+{
+   Hash<Algo> theHash;
+   details::hashMessage<Algo>( theHash, input, len );
+   return getDigest<Algo>( theHash );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a message and write the hex digest to out.
+ *
+ *  Writes Digest<Algo>::hex_size characters, without a terminating null, and
+ *  returns the end of the output.  Does not allocate.
+ */
+template <typename Algo>
+inline char* hashStrg( std::uint8_t const* input, std::size_t len, char* out )
+{
+   Hash<Algo> theHash;
+   details::hashMessage<Algo>( theHash, input, len );
+   return getDigest<Algo>( theHash, out );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Binary digest of a message.  Does not allocate.
+ */
+template <typename Algo>
+inline Digest<Algo> hashDigest( std::uint8_t const* input, std::size_t len )
+{
+   Hash<Algo> theHash;
+   details::hashMessage<Algo>( theHash, input, len );
+
+   Digest<Algo> digest;
+   getDigest<Algo>( theHash, digest );
+   return digest;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Binary digest of a string.  Does not allocate.
+ */
+template <typename Algo>
+ALWAYS_INLINE Digest<Algo> hashDigest( std::string_view input )
+{
+   return hashDigest<Algo>( reinterpret_cast< std::uint8_t const* >( input.data() ),
+                            input.length() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a string with the given algorithm.
+ */
+template <typename Algo>
+ALWAYS_INLINE std::string hashStrg( std::string_view input )
+{
+   return hashStrg<Algo>( reinterpret_cast< std::uint8_t const* >( input.data() ),
+                          input.length() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a byte buffer with the given algorithm.
+ */
+template <typename Algo>
+ALWAYS_INLINE std::string hashStrg( std::vector< std::uint8_t > const& input )
+{
+   return hashStrg<Algo>( input.data(), input.size() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a byte buffer with the given algorithm.
+ */
+template <typename Algo>
+ALWAYS_INLINE std::string hashStrg( std::vector< std::byte > const& input )
+{
+   return hashStrg<Algo>( reinterpret_cast< std::uint8_t const* >( input.data() ),
+                          input.size() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a byte array with the given algorithm.
+ */
+template <typename Algo, std::size_t N>
+ALWAYS_INLINE std::string hashStrg( std::uint8_t const (&input)[N] )
+{
+   return hashStrg<Algo>( input, N );
+}
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Batch of messages for an algorithm without a multi-buffer kernel.
+ */
+template <typename Algo>
+inline void
+hashBatch( std::vector< std::string_view > const& inputs,
+           std::vector< std::string >& digests, std::false_type )
+{
+   for( std::size_t idx( 0 ); idx != inputs.size(); ++idx )
+   {
+      digests[idx] = hashStrg<Algo>( inputs[idx] );
+   }
+}
+
+
+
+#if HDQRT_X86_BACKENDS
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One message being hashed in a lane of the multi-buffer kernel.
+ */
+template <typename Algo>
+struct BatchLane
+{
+   std::size_t msgIdx;
+   std::uint8_t const* next;
+   std::size_t fullChunksLeft;
+   LastChunks<Algo> lastChunks;
+   std::size_t lastChunksDone;
+   std::size_t lastChunksLen;
+   bool active;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash messages 8 at a time with the AVX2 SHA256 kernel.
+ *
+ *  Each lane runs its own message.  As soon as a lane finishes, its digest is
+ *  written and the next message of the batch is loaded in it, so lanes stay
+ *  busy even when the messages have different lengths.  Lanes left without a
+ *  message compress a dummy chunk whose result is ignored.
+ */
+template <typename Algo>
+inline void
+hashBatchX8( std::vector< std::string_view > const& inputs,
+             std::vector< std::string >& digests )
+{
+   constexpr std::size_t nbOfLanes( 8 );
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+
+   alignas( 32 ) std::uint32_t state[8][nbOfLanes];
+   std::array< BatchLane<Algo>, nbOfLanes > lanes;
+   std::array< std::uint8_t, chunkBytes > const dummy = {};
+   std::size_t nextMsg( 0 );
+
+   auto startLane = [&]( std::size_t laneIdx )
+   {
+      BatchLane<Algo>& lane( lanes[laneIdx] );
+      lane.active = ( nextMsg != inputs.size() );
+      if( !lane.active ) { return; }
+
+      std::string_view msg( inputs[nextMsg] );
+      auto input = reinterpret_cast< std::uint8_t const* >( msg.data() );
+      lane.msgIdx = nextMsg++;
+      lane.next = input;
+      lane.fullChunksLeft = msg.length() / chunkBytes;
+      lane.lastChunksDone = 0;
+      lane.lastChunksLen = padLastChunk<Algo>( lane.lastChunks,
+                                 input + lane.fullChunksLeft * chunkBytes,
+                                 msg.length() % chunkBytes, msg.length() );
+
+      for( std::size_t word( 0 ); word != 8; ++word )
+      {
+         state[word][laneIdx] = Algo::initHashVals[word];
+      }
+   };
+
+   for( std::size_t laneIdx( 0 ); laneIdx != nbOfLanes; ++laneIdx )
+   {
+      startLane( laneIdx );
+   }
+
+   std::uint8_t const* blocks[nbOfLanes];
+   bool anyActive( lanes[0].active );
+   while( anyActive )
+   {
+      for( std::size_t laneIdx( 0 ); laneIdx != nbOfLanes; ++laneIdx )
+      {
+         BatchLane<Algo> const& lane( lanes[laneIdx] );
+         if( !lane.active )              { blocks[laneIdx] = dummy.data(); }
+         else if( lane.fullChunksLeft )  { blocks[laneIdx] = lane.next; }
+         else { blocks[laneIdx] = lane.lastChunks.data() + lane.lastChunksDone * chunkBytes; }
+      }
+
+      sha256x8BlocksAvx2( state, blocks );
+
+      anyActive = false;
+      for( std::size_t laneIdx( 0 ); laneIdx != nbOfLanes; ++laneIdx )
+      {
+         BatchLane<Algo>& lane( lanes[laneIdx] );
+         if( !lane.active ) { continue; }
+
+         if( lane.fullChunksLeft ) { --lane.fullChunksLeft; lane.next += chunkBytes; }
+         else                      { ++lane.lastChunksDone; }
+
+         if( lane.lastChunksDone == lane.lastChunksLen )
+         {
+            Hash<Algo> theHash;
+            for( std::size_t word( 0 ); word != 8; ++word )
+            {
+               theHash.state[word] = state[word][laneIdx];
+            }
+            digests[lane.msgIdx] = getDigest<Algo>( theHash );
+            startLane( laneIdx );
+         }
+
+         anyActive = anyActive || lane.active;
+      }
+   }
+}
+#endif // HDQRT_X86_BACKENDS
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Batch of messages for the SHA256 family.
+ *
+ *  The AVX2 multi-buffer kernel is used when batchBackend selects it.
+ */
+template <typename Algo>
+inline void
+hashBatch( std::vector< std::string_view > const& inputs,
+           std::vector< std::string >& digests, std::true_type )
+{
+#if HDQRT_X86_BACKENDS
+   if( batchBackend<Algo>() == Backend::AVX2 )
+   {
+      hashBatchX8<Algo>( inputs, digests );
+      return;
+   }
+#endif
+
+   hashBatch<Algo>( inputs, digests, std::false_type() );
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash many independent messages with the given algorithm.
+ *
+ *  Returns one digest per input, in the same order, identical to what
+ *  hashStrg<Algo> returns for each of them.  SHA256 and SHA224 hash several
+ *  messages side by side when a multi-buffer kernel is available.
+ */
+template <typename Algo>
+inline std::vector< std::string >
+hashBatch( std::vector< std::string_view > const& inputs )
+{
+   std::vector< std::string > digests( inputs.size() );
+   details::hashBatch<Algo>( inputs, digests,
+                   std::is_same< typename Algo::family, SHA256 >() );
+   return digests;
+}
+
+
 } // namespace hashes
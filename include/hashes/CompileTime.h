@@ -0,0 +1,47 @@
+#ifndef HDQRT_HASH_COMPILE_TIME_H_
+#define HDQRT_HASH_COMPILE_TIME_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <string_view>
+
+#include "../hashes.h"
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hashing usable in constant expressions.
+ *
+ *  For identifiers known at compile time : the digest can be used in a
+ *  static_assert, as a case label (through its bytes) or as a template
+ *  argument and costs nothing at runtime.  Slower than the runtime functions
+ *  when called at runtime, since no backend is used.
+ *
+ *  @code
+ *     constexpr auto id( hashes::ct::sha256( "schema.v2" ) );
+ *     static_assert( id.bytes[0] == 0x.., "" );
+ *  @endcode
+ */
+namespace ct
+{
+
+template< typename Algo >
+constexpr Digest<Algo> hash( std::string_view input );
+
+constexpr Digest<SHA224> sha224( std::string_view input );
+
+constexpr Digest<SHA256> sha256( std::string_view input );
+
+constexpr Digest<SHA384> sha384( std::string_view input );
+
+constexpr Digest<SHA512> sha512( std::string_view input );
+
+} // namespace ct
+
+} // namespace hashes
+
+#include "CompileTime.inl"
+
+#endif // HDQRT_HASH_COMPILE_TIME_H_
@@ -0,0 +1,130 @@
+namespace hashes
+{
+
+namespace ct
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Byte pos of the padded message.
+ *
+ *  The message, the 1 bit, zeros, and the length in bits, big endian, in the
+ *  last len_encode_len bits of the paddedLen bytes.
+ */
+template< typename Algo >
+constexpr std::uint8_t
+paddedByte( std::string_view input, std::size_t pos, std::size_t paddedLen )
+{
+   if( pos < input.size() )
+   {
+      return static_cast< std::uint8_t >( input[pos] );
+   }
+   if( pos == input.size() )
+   {
+      return 0x80;
+   }
+
+   // Byte index from the end : the length in bits is len << 3, the bits
+   // shifted out only reach the ninth byte of a 128 bits length
+   std::size_t const fromEnd( paddedLen - 1 - pos );
+   std::uint64_t const len( input.size() );
+   if( fromEnd < 8 )
+   {
+      return static_cast< std::uint8_t >( ( len << 3 ) >> ( CHAR_BIT * fromEnd ) );
+   }
+   if( fromEnd == 8 && Algo::len_encode_len > 64 )
+   {
+      return static_cast< std::uint8_t >( len >> 61 );
+   }
+   return 0;
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Digest of input with an algorithm of the SHA2 family.
+ *
+ *  Goes through the same schedule expansion and round functions as the
+ *  portable runtime kernel, one chunk at a time, with the padding generated
+ *  on the fly.
+ */
+template< typename Algo >
+constexpr Digest<Algo> hash( std::string_view input )
+{
+   static_assert( is_sha2_derived< Algo >::value,
+                  "Compile time hashing is implemented for the SHA2 family." );
+
+   typedef typename Algo::word_t word_t;
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   constexpr std::size_t lenBytes( Algo::len_encode_len / CHAR_BIT );
+   std::size_t const paddedLen( ( input.size() + 1 + lenBytes + chunkBytes - 1 ) /
+                                chunkBytes * chunkBytes );
+
+   typename Hash<Algo>::hash_type state( Algo::initHashVals );
+   for( std::size_t offset( 0 ); offset != paddedLen; offset += chunkBytes )
+   {
+      // Big endian words of the padded chunk
+      typename hashes::details::schedule_words< Algo, hashes::details::FullSchedule >::type W{};
+      for( std::size_t idx( 0 ); idx != chunkBytes; ++idx )
+      {
+         W[idx / sizeof( word_t )] = static_cast< word_t >( ( W[idx / sizeof( word_t )] << 8 ) |
+               details::paddedByte<Algo>( input, offset + idx, paddedLen ) );
+      }
+
+      hashes::details::expandSchedule<Algo>( W );
+      hashes::details::sha2Rounds<Algo>( state, W, hashes::details::LoopRounds(),
+                                         hashes::details::FullSchedule() );
+   }
+
+   // Big endian bytes of the state, truncated to the digest length
+   Digest<Algo> digest{};
+   for( std::size_t idx( 0 ); idx != Digest<Algo>::size; ++idx )
+   {
+      std::size_t const shift( sizeof( word_t ) - 1 - idx % sizeof( word_t ) );
+      digest.bytes[idx] = static_cast< std::uint8_t >(
+                              state[idx / sizeof( word_t )] >> ( CHAR_BIT * shift ) );
+   }
+   return digest;
+}
+
+
+
+//------------------------------------------------------------------------------
+constexpr Digest<SHA224> sha224( std::string_view input )
+{
+   return hash<SHA224>( input );
+}
+
+
+
+//------------------------------------------------------------------------------
+constexpr Digest<SHA256> sha256( std::string_view input )
+{
+   return hash<SHA256>( input );
+}
+
+
+
+//------------------------------------------------------------------------------
+constexpr Digest<SHA384> sha384( std::string_view input )
+{
+   return hash<SHA384>( input );
+}
+
+
+
+//------------------------------------------------------------------------------
+constexpr Digest<SHA512> sha512( std::string_view input )
+{
+   return hash<SHA512>( input );
+}
+
+} // namespace ct
+
+} // namespace hashes
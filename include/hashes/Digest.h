@@ -0,0 +1,84 @@
+#ifndef HDQRT_HASH_DIGEST_H_
+#define HDQRT_HASH_DIGEST_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <climits> // for CHAR_BIT
+#include <array>
+#include <string>
+#include <string_view>
+#include <iosfwd>
+#include <functional> // for std::hash
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Binary digest of a message, digest_len bits long.
+ *
+ *  A plain value : copying and comparing it never allocates.  The hex
+ *  representation is only computed when asked for, either into caller memory
+ *  with toHex or as a string with hex.
+ */
+template< typename Algo >
+struct Digest
+{
+   static constexpr std::size_t size = Algo::digest_len / CHAR_BIT;
+   static constexpr std::size_t hex_size = 2 * size;
+   typedef std::array< std::uint8_t, size > bytes_type;
+
+   bytes_type bytes;
+
+   char* toHex( char* out ) const;
+   std::string hex() const;
+
+   static constexpr bool fromHex( std::string_view hex, Digest& digest );
+};
+
+
+
+template< typename Algo >
+constexpr bool operator == ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+constexpr bool operator != ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+constexpr bool operator < ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+constexpr bool operator > ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+constexpr bool operator <= ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+constexpr bool operator >= ( Digest<Algo> const& lhs, Digest<Algo> const& rhs );
+
+template< typename Algo >
+std::ostream& operator << ( std::ostream& ostrm, Digest<Algo> const& digest );
+
+
+} // namespace hashes
+
+
+
+namespace std
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Digests as keys of unordered containers.
+ */
+template< typename Algo >
+struct hash< hashes::Digest<Algo> >
+{
+   std::size_t operator()( hashes::Digest<Algo> const& digest ) const noexcept;
+};
+
+} // namespace std
+
+#include "Digest.inl"
+
+#endif // HDQRT_HASH_DIGEST_H_
@@ -0,0 +1,172 @@
+#include <cstring> // for std::memcpy
+#include <ostream>
+
+#include "../always_inline.h"
+#include "../bits.h"
+
+namespace hashes
+{
+
+template< typename Algo >
+constexpr std::size_t Digest<Algo>::size;
+
+template< typename Algo >
+constexpr std::size_t Digest<Algo>::hex_size;
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Write the lowercase hex representation to out.
+ *
+ *  Writes hex_size characters, without a terminating null, and returns the
+ *  end of the output.  Does not allocate.
+ */
+template< typename Algo >
+ALWAYS_INLINE char* Digest<Algo>::toHex( char* out ) const
+{
+   return bits::to_hex( bytes.data(), size, out );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Lowercase hex representation, as hashStrg returns it.
+ */
+template< typename Algo >
+inline std::string Digest<Algo>::hex() const
+{
+   std::string strg( hex_size, '0' );
+   toHex( &strg[0] );
+   return strg;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Digest with the given hex representation, in either case.
+ *
+ *  Returns false, leaving digest unspecified, unless hex is exactly hex_size
+ *  hex digits.
+ */
+template< typename Algo >
+constexpr bool Digest<Algo>::fromHex( std::string_view hex, Digest& digest )
+{
+   return hex.size() == hex_size && bits::from_hex( hex, digest.bytes.data() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether two digests are identical.
+ *
+ *  Compares every byte without branching, which also keeps the time spent
+ *  independent of where the digests differ.
+ */
+template< typename Algo >
+constexpr bool operator == ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   std::uint8_t diff( 0 );
+   for( std::size_t idx( 0 ); idx != Digest<Algo>::size; ++idx )
+   {
+      diff |= lhs.bytes[idx] ^ rhs.bytes[idx];
+   }
+   return diff == 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+constexpr bool operator != ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   return !( lhs == rhs );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Lexicographic order of the bytes, which is also the order of the
+ *         hex representations.
+ */
+template< typename Algo >
+constexpr bool operator < ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   for( std::size_t idx( 0 ); idx != Digest<Algo>::size; ++idx )
+   {
+      if( lhs.bytes[idx] != rhs.bytes[idx] )
+      {
+         return lhs.bytes[idx] < rhs.bytes[idx];
+      }
+   }
+   return false;
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+constexpr bool operator > ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   return rhs < lhs;
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+constexpr bool operator <= ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   return !( rhs < lhs );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+constexpr bool operator >= ( Digest<Algo> const& lhs, Digest<Algo> const& rhs )
+{
+   return !( lhs < rhs );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Output the hex representation, formatted on the stack.
+ */
+template< typename Algo >
+inline std::ostream& operator << ( std::ostream& ostrm, Digest<Algo> const& digest )
+{
+   char hex[Digest<Algo>::hex_size];
+   digest.toHex( hex );
+   return ostrm.write( hex, Digest<Algo>::hex_size );
+}
+
+} // namespace hashes
+
+
+
+namespace std
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief The leading bytes of a digest are already uniformly distributed.
+ */
+template< typename Algo >
+inline std::size_t
+hash< hashes::Digest<Algo> >::operator()( hashes::Digest<Algo> const& digest ) const noexcept
+{
+   static_assert( hashes::Digest<Algo>::size >= sizeof( std::size_t ),
+                  "Digest shorter than a std::size_t." );
+   std::size_t value( 0 );
+   std::memcpy( &value, digest.bytes.data(), sizeof( value ) );
+   return value;
+}
+
+} // namespace std
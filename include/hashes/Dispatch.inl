@@ -0,0 +1,595 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <cstdlib> // for std::getenv
+#include <cstring> // for std::strcmp
+#include <climits> // for CHAR_BIT
+#include <array>
+#include <iterator> // for std::size
+#include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Names accepted by backendFromName, in Backend order.
+ */
+constexpr char const* backend_names[] = { "scalar", "bmi2", "ssse3", "sha-ni", "avx2" };
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Environment variable forcing a backend, for testing.
+ *
+ *  Holds one of the backend_names.  Ignored for the algorithms the named
+ *  backend does not implement or when the CPU does not support it.
+ */
+constexpr char const* backend_variable = "HDQRT_HASH_BACKEND";
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backends from the fastest to the slowest, as measured with
+ *         hashing_bench.
+ */
+constexpr Backend backend_preference[] = { Backend::SHA_NI, Backend::SSSE3,
+                                           Backend::BMI2, Backend::SCALAR };
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Portable kernel, compiled for the baseline instruction set.
+ */
+template< typename Algo >
+inline void
+scalarBlocks( typename Hash<Algo>::hash_type& state,
+              std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   processBlocks<Algo>( state, blocks, nbOfBlocks, typename kernel_tag< Algo >::type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Portable zero chunks kernel, compiled for the baseline instruction
+ *         set.
+ */
+template< typename Algo >
+inline void
+scalarZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks )
+{
+   processZeroBlocks<Algo>( state, nbOfBlocks, typename kernel_tag< Algo >::type() );
+}
+
+
+
+#if HDQRT_X86_BACKENDS
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Portable SHA2 kernel compiled with BMI1 and BMI2.
+ *
+ *  Same source as scalarBlocks : the compiler uses rorx for the rotations
+ *  (no copy of the rotated word, flags untouched) and andn in Ch.
+ */
+template< typename Algo >
+HDQRT_TARGET( "bmi,bmi2" )
+inline void
+bmi2Blocks( typename Hash<Algo>::hash_type& state,
+            std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   processBlocks<Algo>( state, blocks, nbOfBlocks, std::true_type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+HDQRT_TARGET( "bmi,bmi2" )
+inline void
+bmi2ZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks )
+{
+   processZeroBlocks<Algo>( state, nbOfBlocks, std::true_type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline void
+ssse3Blocks( typename Hash<Algo>::hash_type& state,
+             std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   sha256BlocksSsse3( state.data(), blocks, nbOfBlocks );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline void
+shaNiBlocks( typename Hash<Algo>::hash_type& state,
+             std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   sha256BlocksShaNi( state.data(), blocks, nbOfBlocks );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline void
+shaNiZeroBlocks( typename Hash<Algo>::hash_type& state, std::uint64_t nbOfBlocks )
+{
+   sha256ZeroBlocksShaNi( state.data(), nbOfBlocks );
+}
+
+
+
+//------------------------------------------------------------------------------
+inline void
+sha1ShaNiBlocks( Hash<SHA1>::hash_type& state,
+                 std::uint8_t const* blocks, std::size_t nbOfBlocks )
+{
+   sha1BlocksShaNi( state.data(), blocks, nbOfBlocks );
+}
+#endif
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief BMI2 kernel of an algorithm without one.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+bmi2Backend( std::false_type )
+{
+   return nullptr;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief BMI2 kernel of the SHA2 family.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+bmi2Backend( std::true_type )
+{
+#if HDQRT_X86_BACKENDS
+   return cpu::hasBmi2() ? &bmi2Blocks<Algo> : nullptr;
+#else
+   return nullptr;
+#endif
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backends shared by all the algorithms.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+backendBlocks( Backend backend, std::false_type )
+{
+   switch( backend )
+   {
+      case Backend::SCALAR:
+         return &scalarBlocks<Algo>;
+      case Backend::BMI2:
+         return bmi2Backend<Algo>( is_sha2< Algo >() );
+      default:
+         return nullptr;
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backends of the SHA256 family, which adds the SSSE3 and SHA-NI
+ *         kernels.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+backendBlocks( Backend backend, std::true_type )
+{
+#if HDQRT_X86_BACKENDS
+   if( backend == Backend::SHA_NI )
+   {
+      return cpu::hasShaNi() ? &shaNiBlocks<Algo> : nullptr;
+   }
+   if( backend == Backend::SSSE3 )
+   {
+      return cpu::hasSsse3() ? &ssse3Blocks<Algo> : nullptr;
+   }
+#endif
+
+   return backendBlocks<Algo>( backend, std::false_type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backends of SHA1, which adds the SHA-NI kernel.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+backendBlocks( Backend backend, SHA1 )
+{
+#if HDQRT_X86_BACKENDS
+   if( backend == Backend::SHA_NI )
+   {
+      return cpu::hasShaNi() ? &sha1ShaNiBlocks : nullptr;
+   }
+#endif
+
+   return backendBlocks<Algo>( backend, std::false_type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Tag of the backends of Algo, for backendBlocks.
+ *
+ *  std::true_type for the SHA256 family, the algorithm itself when it has
+ *  its own accelerated kernels, std::false_type otherwise.
+ */
+template< typename Algo >
+struct backend_tag
+{
+   typedef std::is_same< typename Algo::family, SHA256 > type;
+};
+
+template<>
+struct backend_tag< SHA1 >
+{
+   typedef SHA1 type;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Zero chunks kernel of an algorithm without one : processZeroBlocks
+ *         reads a buffer of zeros through processBlocks.
+ */
+template< typename Algo >
+inline zero_blocks_fn<Algo>
+backendZeroBlocks( Backend, std::false_type )
+{
+   return &scalarZeroBlocks<Algo>;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Zero chunks kernels of the SHA2 family.
+ *
+ *  SHA-NI for the SHA256 family, the portable rounds otherwise : without a
+ *  schedule to compute, the SSSE3 kernel has nothing left to vectorize.
+ */
+template< typename Algo >
+inline zero_blocks_fn<Algo>
+backendZeroBlocks( Backend backend, std::true_type )
+{
+#if HDQRT_X86_BACKENDS
+   if constexpr( std::is_same< typename Algo::family, SHA256 >::value )
+   {
+      if( backend == Backend::SHA_NI ) { return &shaNiZeroBlocks<Algo>; }
+   }
+   if( backend == Backend::BMI2 )
+   {
+      return &bmi2ZeroBlocks<Algo>;
+   }
+#else
+   static_cast< void >( backend );
+#endif
+
+   return &scalarZeroBlocks<Algo>;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backend for the chunks of Algo.
+ *
+ *  The forced backend (null for none) when usable, the fastest one this CPU
+ *  supports otherwise.
+ */
+template< typename Algo >
+inline Backend
+selectBackend( char const* forced )
+{
+   Backend backend( Backend::SCALAR );
+   if( forced != nullptr && backendFromName( forced, backend ) &&
+       backendBlocks<Algo>( backend ) != nullptr )
+   {
+      return backend;
+   }
+
+   for( Backend candidate : backend_preference )
+   {
+      if( backendBlocks<Algo>( candidate ) != nullptr )
+      {
+         return candidate;
+      }
+   }
+   return Backend::SCALAR;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backend for the batches of Algo.
+ *
+ *  The AVX2 multi-buffer kernel when forced, or when the CPU supports AVX2
+ *  but not the SHA extensions : one SHA-NI stream is faster than 8 AVX2
+ *  lanes.
+ */
+template< typename Algo >
+inline Backend
+selectBatchBackend( char const* forced )
+{
+   Backend backend( Backend::SCALAR );
+   bool const isForced( forced != nullptr && backendFromName( forced, backend ) );
+
+   if( std::is_same< typename Algo::family, SHA256 >::value && cpu::hasAvx2() &&
+       ( isForced ? backend == Backend::AVX2
+                  : selectBackend<Algo>( nullptr ) != Backend::SHA_NI ) )
+   {
+      return Backend::AVX2;
+   }
+   return selectBackend<Algo>( forced );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Chunks of pseudo random bytes for the self-test.
+ */
+template< typename Algo >
+inline std::array< std::uint8_t, 7 * Algo::chunk_size / CHAR_BIT >
+selfTestMessage()
+{
+   std::array< std::uint8_t, 7 * Algo::chunk_size / CHAR_BIT > msg;
+   std::uint32_t seed( 0x9e3779b9 );
+   for( auto& byte : msg )
+   {
+      seed = seed * 1664525u + 1013904223u;
+      byte = static_cast< std::uint8_t >( seed >> 24 );
+   }
+   return msg;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief No multi-buffer kernel to check.
+ */
+template< typename Algo >
+inline bool
+selfTestBatch( std::false_type )
+{
+   return true;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Check the AVX2 multi-buffer kernel against one message at a time.
+ */
+template< typename Algo >
+inline bool
+selfTestBatch( std::true_type )
+{
+#if HDQRT_X86_BACKENDS
+   if( !cpu::hasAvx2() ) { return true; }
+
+   auto const msg( selfTestMessage<Algo>() );
+   std::vector< std::string_view > inputs;
+   for( std::size_t len( 0 ); len <= msg.size(); len += 37 )
+   {
+      inputs.emplace_back( reinterpret_cast< char const* >( msg.data() ), len );
+   }
+
+   std::vector< std::string > expected( inputs.size() ), digests( inputs.size() );
+   hashBatch<Algo>( inputs, expected, std::false_type() );
+   hashBatchX8<Algo>( inputs, digests );
+   return digests == expected;
+#else
+   return true;
+#endif
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Name of a backend, as accepted by backendFromName.
+ */
+inline char const*
+backendName( Backend backend )
+{
+   return details::backend_names[static_cast< std::size_t >( backend )];
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backend with the given name.
+ *
+ *  Returns false and leaves backend unchanged for an unknown name.
+ */
+inline bool
+backendFromName( char const* name, Backend& backend )
+{
+   for( std::size_t idx( 0 ); idx != std::size( details::backend_names ); ++idx )
+   {
+      if( std::strcmp( name, details::backend_names[idx] ) == 0 )
+      {
+         backend = static_cast< Backend >( idx );
+         return true;
+      }
+   }
+   return false;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Chunk processing function of a backend.
+ *
+ *  Null when the backend is not compiled in, does not implement Algo or is
+ *  not supported by this CPU.  SCALAR is always available.
+ */
+template< typename Algo >
+inline blocks_fn<Algo>
+backendBlocks( Backend backend )
+{
+   return details::backendBlocks<Algo>( backend,
+                      typename details::backend_tag< Algo >::type() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Zero chunks processing function of a backend.
+ *
+ *  Null when backendBlocks is null for this backend.
+ */
+template< typename Algo >
+inline zero_blocks_fn<Algo>
+backendZeroBlocks( Backend backend )
+{
+   if( backendBlocks<Algo>( backend ) == nullptr ) { return nullptr; }
+   return details::backendZeroBlocks<Algo>( backend, is_sha2< Algo >() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backend processBlocks uses for Algo.
+ *
+ *  Chosen on the first call : the one named by the HDQRT_HASH_BACKEND
+ *  environment variable if it is usable, the fastest one the CPU supports
+ *  otherwise.
+ */
+template< typename Algo >
+inline Backend
+selectedBackend()
+{
+   static Backend const selected(
+               details::selectBackend<Algo>( std::getenv( details::backend_variable ) ) );
+   return selected;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Backend hashBatch uses for Algo.
+ *
+ *  AVX2 for the multi-buffer kernel, otherwise the same as selectedBackend.
+ */
+template< typename Algo >
+inline Backend
+batchBackend()
+{
+   static Backend const selected(
+               details::selectBatchBackend<Algo>( std::getenv( details::backend_variable ) ) );
+   return selected;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Check every backend available for Algo against the scalar one.
+ *
+ *  Runs a single chunk and a run of six chunks through each of them, then
+ *  three zero chunks through its zero chunks kernel, then the multi-buffer
+ *  kernel if any.  Returns false on the first mismatch.
+ */
+template< typename Algo >
+inline bool
+selfTest()
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   auto const msg( details::selfTestMessage<Algo>() );
+   std::array< std::uint8_t, 3 * chunkBytes > const zeros{};
+
+   Hash<Algo> expected;
+   initializeHash( expected );
+   details::scalarBlocks<Algo>( expected.state, msg.data(), 1 );
+   details::scalarBlocks<Algo>( expected.state, msg.data() + chunkBytes, 6 );
+
+   for( Backend backend : details::backend_preference )
+   {
+      blocks_fn<Algo> const blocks( backendBlocks<Algo>( backend ) );
+      if( blocks == nullptr ) { continue; }
+
+      Hash<Algo> theHash;
+      initializeHash( theHash );
+      blocks( theHash.state, msg.data(), 1 );
+      blocks( theHash.state, msg.data() + chunkBytes, 6 );
+      if( theHash.state != expected.state ) { return false; }
+
+      zero_blocks_fn<Algo> const zeroBlocks( backendZeroBlocks<Algo>( backend ) );
+      zeroBlocks( theHash.state, 3 );
+      details::scalarBlocks<Algo>( expected.state, zeros.data(), 3 );
+      if( theHash.state != expected.state ) { return false; }
+      initializeHash( expected );
+      details::scalarBlocks<Algo>( expected.state, msg.data(), 1 );
+      details::scalarBlocks<Algo>( expected.state, msg.data() + chunkBytes, 6 );
+   }
+
+   return details::selfTestBatch<Algo>(
+                      std::is_same< typename Algo::family, SHA256 >() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Check every backend of every implemented algorithm.
+ */
+inline bool
+selfTest()
+{
+   return selfTest<MD5>() && selfTest<SHA1>() &&
+          selfTest<SHA256>() && selfTest<SHA224>() &&
+          selfTest<SHA512>() && selfTest<SHA384>() &&
+          selfTest<SHA512_224>() && selfTest<SHA512_256>();
+}
+
+} // namespace hashes
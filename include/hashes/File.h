@@ -0,0 +1,138 @@
+#ifndef HDQRT_HASH_FILE_H_
+#define HDQRT_HASH_FILE_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <chrono>
+#include <string>
+
+#include "../hashes.h"
+
+
+//------------------------------------------------------------------------------
+// File hashing uses mmap and read : POSIX systems only.
+#if defined( __unix__ ) || defined( __APPLE__ )
+#  define HDQRT_POSIX_FILES 1
+#else
+#  define HDQRT_POSIX_FILES 0
+#endif
+
+//------------------------------------------------------------------------------
+// io_uring is driven through the raw system calls : it only needs the kernel
+// headers, not liburing.
+#if HDQRT_POSIX_FILES && defined( __linux__ ) && __has_include( <linux/io_uring.h> )
+#  define HDQRT_IO_URING 1
+#else
+#  define HDQRT_IO_URING 0
+#endif
+
+
+#if HDQRT_POSIX_FILES
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief How hashFile reads a file.
+ *
+ *  Regular files are mapped window by window and the pages fed straight to
+ *  the chunk kernel, so memory use does not grow with the file size.  Pipes,
+ *  character devices and files that cannot be mapped are read through a
+ *  buffer instead.
+ *
+ *  Mapping a file leaves it in the page cache.  To scan data without
+ *  evicting the working set of the rest of the system, direct and dropCache
+ *  read regular files around the cache, with queueDepth reads in flight to
+ *  keep the throughput up.
+ */
+struct FileOptions
+{
+   /*! Bytes mapped at a time, rounded up to a multiple of huge_page_size. */
+   std::size_t windowSize = std::size_t( 1 ) << 30;
+
+   /*! Fault the whole window in when mapping it (MAP_POPULATE, Linux only)
+    *  instead of relying on the kernel readahead. */
+   bool populate = false;
+
+   /*! Never map : always use the read() loop. */
+   bool forceRead = false;
+
+   /*! Buffer size of the read() loop, and of each buffer of the ring. */
+   std::size_t bufferSize = std::size_t( 1 ) << 20;
+
+   /*! Read on a separate thread, see hashFilePipelined.  Used for regular
+    *  files instead of mapping them. */
+   bool pipelined = false;
+
+   /*! Number of buffers the reader thread can fill ahead of the hasher. */
+   std::size_t ringSlots = 4;
+
+   /*! Hash the holes of sparse files as zeros without reading them, found
+    *  with SEEK_DATA / SEEK_HOLE.  Mapped and read() modes only. */
+   bool skipHoles = true;
+
+   /*! Read with O_DIRECT, bypassing the page cache.  Falls back to dropCache
+    *  where the file system refuses O_DIRECT. */
+   bool direct = false;
+
+   /*! Read through the page cache, but drop the pages already hashed from it
+    *  with posix_fadvise( POSIX_FADV_DONTNEED ). */
+   bool dropCache = false;
+
+   /*! Reads of bufferSize bytes in flight in the direct and dropCache modes. */
+   std::size_t queueDepth = 8;
+
+   /*! Alignment of the buffers, offsets and lengths of O_DIRECT reads. */
+   static constexpr std::size_t direct_alignment = 4096;
+
+   /*! Alignment of the mapped windows : the size of an x86 huge page. */
+   static constexpr std::size_t huge_page_size = std::size_t( 1 ) << 21;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief What the two threads of hashFilePipelined spent their time on.
+ *
+ *  A reader stalled on a full ring means hashing is the bottleneck, a hasher
+ *  stalled on an empty ring means the disk is.
+ */
+struct PipelineStats
+{
+   /*! Bytes hashed. */
+   std::uint64_t bytes = 0;
+
+   /*! Time the reader waited for a free buffer. */
+   std::chrono::nanoseconds readerStalled{ 0 };
+
+   /*! Time the hasher waited for a filled buffer. */
+   std::chrono::nanoseconds hasherStalled{ 0 };
+};
+
+
+template< typename Algo >
+std::string hashFile( std::string const& path, FileOptions const& options = FileOptions() );
+
+template< typename Algo >
+void hashFile( std::string const& path, Digest<Algo>& digest,
+               FileOptions const& options = FileOptions() );
+
+template< typename Algo >
+void hashFile( int fd, Digest<Algo>& digest, FileOptions const& options = FileOptions() );
+
+template< typename Algo >
+void hashFilePipelined( int fd, Digest<Algo>& digest, PipelineStats& stats,
+                        FileOptions const& options = FileOptions() );
+
+bool ioUringAvailable();
+
+
+} // namespace hashes
+
+#include "File.inl"
+
+#endif // HDQRT_POSIX_FILES
+
+#endif // HDQRT_HASH_FILE_H_
@@ -0,0 +1,908 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new> // for std::align_val_t
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "IoUring.inl"
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether io_uring can be used on this system.
+ *
+ *  hashFiles and the direct and dropCache modes of hashFile use it.  Needs a
+ *  kernel with io_uring enabled and allowed (containers often filter it
+ *  out), and implementing the open, read and close operations (5.6+).
+ *  Probed once.
+ */
+inline bool
+ioUringAvailable()
+{
+#if HDQRT_IO_URING
+   static bool const available( []()
+   {
+      details::IoUring ring( 4 );
+      return ring.valid() &&
+             ring.supports( { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE } );
+   }() );
+   return available;
+#else
+   return false;
+#endif
+}
+
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief File descriptor closed on destruction.
+ */
+struct FileDescriptor
+{
+   explicit FileDescriptor( int fd ) : fd_( fd ) {}
+   ~FileDescriptor() { if( fd_ >= 0 ) { ::close( fd_ ); } }
+
+   FileDescriptor( FileDescriptor const& ) = delete;
+   FileDescriptor& operator = ( FileDescriptor const& ) = delete;
+
+   int fd_;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Mapped window of a file, unmapped on destruction.
+ */
+struct MappedWindow
+{
+   MappedWindow( int fd, std::uint64_t offset, std::size_t len, bool populate )
+      : len_( len )
+   {
+      int flags( MAP_PRIVATE );
+#ifdef MAP_POPULATE
+      if( populate ) { flags |= MAP_POPULATE; }
+#else
+      static_cast< void >( populate );
+#endif
+      addr_ = ::mmap( nullptr, len, PROT_READ, flags, fd, static_cast< off_t >( offset ) );
+   }
+   ~MappedWindow() { if( valid() ) { ::munmap( addr_, len_ ); } }
+
+   MappedWindow( MappedWindow const& ) = delete;
+   MappedWindow& operator = ( MappedWindow const& ) = delete;
+
+   bool valid() const { return addr_ != MAP_FAILED; }
+   std::uint8_t const* data() const { return static_cast< std::uint8_t const* >( addr_ ); }
+
+   void* addr_;
+   std::size_t len_;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Error of the last system call, as an exception.
+ */
+inline std::system_error
+fileError( std::string const& what )
+{
+   return std::system_error( errno, std::generic_category(), "hashFile: " + what );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash bytes begin to end of a regular file through mappings.
+ *
+ *  Windows are multiples of huge_page_size and start on a multiple of it, so
+ *  every one of them but the last is a whole number of chunks fed straight to
+ *  the kernel.  While a window is hashed, the kernel is asked to read the
+ *  next one ahead.  Returns the offset reached : less than end when a window
+ *  cannot be mapped, the caller reads the rest.
+ *
+ *  As with any mapping, truncating the file while it is hashed raises SIGBUS.
+ */
+template< typename Algo >
+inline std::uint64_t
+hashMapped( Hasher<Algo>& hasher, int fd, std::uint64_t begin, std::uint64_t end,
+            FileOptions const& options )
+{
+   constexpr std::size_t align( FileOptions::huge_page_size );
+   std::size_t const window( std::max< std::size_t >( align,
+                              ( options.windowSize + align - 1 ) / align * align ) );
+
+#ifdef POSIX_FADV_SEQUENTIAL
+   ::posix_fadvise( fd, static_cast< off_t >( begin ), static_cast< off_t >( end - begin ),
+                    POSIX_FADV_SEQUENTIAL );
+#endif
+
+   std::uint64_t offset( begin );
+   while( offset != end )
+   {
+      // Only the first window can start before offset, when begin is not aligned
+      std::uint64_t const mapStart( offset / align * align );
+      std::size_t const skip( static_cast< std::size_t >( offset - mapStart ) );
+      std::size_t const len( static_cast< std::size_t >(
+                                std::min< std::uint64_t >( window, end - mapStart ) ) );
+
+      MappedWindow mapped( fd, mapStart, len, options.populate );
+      if( !mapped.valid() ) { break; }
+
+      ::madvise( mapped.addr_, len, MADV_SEQUENTIAL );
+      ::madvise( mapped.addr_, len, MADV_WILLNEED );
+#ifdef POSIX_FADV_WILLNEED
+      if( end - mapStart > len )
+      {
+         ::posix_fadvise( fd, static_cast< off_t >( mapStart + len ),
+                          static_cast< off_t >( std::min< std::uint64_t >(
+                                                   window, end - mapStart - len ) ),
+                          POSIX_FADV_WILLNEED );
+      }
+#endif
+
+      hasher.update( mapped.data() + skip, len - skip );
+      offset = mapStart + len;
+   }
+
+   return offset;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash whatever is left to read from fd through a buffer.
+ *
+ *  The buffer holds a whole number of chunks, so full reads go straight to
+ *  the kernel.  Reads interrupted by a signal are retried.
+ */
+template< typename Algo >
+inline void
+hashRead( Hasher<Algo>& hasher, int fd, FileOptions const& options )
+{
+   constexpr std::size_t chunkBytes( Hasher<Algo>::chunk_bytes );
+   std::vector< std::uint8_t > buffer(
+               std::max( chunkBytes, options.bufferSize / chunkBytes * chunkBytes ) );
+
+   for( ;; )
+   {
+      ssize_t const got( ::read( fd, buffer.data(), buffer.size() ) );
+      if( got == 0 ) { return; }
+      if( got < 0 )
+      {
+         if( errno == EINTR ) { continue; }
+         throw fileError( "read failed" );
+      }
+      hasher.update( buffer.data(), static_cast< std::size_t >( got ) );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash bytes begin to end of a file with pread() through a buffer.
+ *
+ *  Stops early if the file is truncated meanwhile.
+ */
+template< typename Algo >
+inline void
+hashPread( Hasher<Algo>& hasher, int fd, std::uint64_t begin, std::uint64_t end,
+           FileOptions const& options )
+{
+   constexpr std::size_t chunkBytes( Hasher<Algo>::chunk_bytes );
+   std::vector< std::uint8_t > buffer(
+               std::max( chunkBytes, options.bufferSize / chunkBytes * chunkBytes ) );
+
+   while( begin != end )
+   {
+      std::size_t const len( static_cast< std::size_t >(
+                                std::min< std::uint64_t >( buffer.size(), end - begin ) ) );
+      ssize_t const got( ::pread( fd, buffer.data(), len, static_cast< off_t >( begin ) ) );
+      if( got == 0 ) { return; }
+      if( got < 0 )
+      {
+         if( errno == EINTR ) { continue; }
+         throw fileError( "read failed" );
+      }
+      hasher.update( buffer.data(), static_cast< std::size_t >( got ) );
+      begin += static_cast< std::uint64_t >( got );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Whether a regular file has holes before its end.
+ *
+ *  Files using as many blocks as their size are not checked further.
+ */
+inline bool
+hasHoles( int fd, struct stat const& info )
+{
+#ifdef SEEK_HOLE
+   if( static_cast< std::uint64_t >( info.st_blocks ) * 512 >=
+       static_cast< std::uint64_t >( info.st_size ) )
+   {
+      return false;
+   }
+   off_t const hole( ::lseek( fd, 0, SEEK_HOLE ) );
+   return hole >= 0 && hole < info.st_size;
+#else
+   static_cast< void >( fd ); static_cast< void >( info );
+   return false;
+#endif
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash the first fileSize bytes of a sparse regular file.
+ *
+ *  SEEK_DATA and SEEK_HOLE walk the data extents, which are mapped or read as
+ *  usual.  The holes are never read : Hasher::updateZeros feeds them to the
+ *  zero chunks kernel.  The digest is the one of the dense file.
+ */
+template< typename Algo >
+inline void
+hashSparse( Hasher<Algo>& hasher, int fd, std::uint64_t fileSize, FileOptions const& options )
+{
+#ifdef SEEK_HOLE
+   std::uint64_t offset( 0 );
+   while( offset != fileSize )
+   {
+      off_t const data( ::lseek( fd, static_cast< off_t >( offset ), SEEK_DATA ) );
+      if( data < 0 && errno != ENXIO ) { throw fileError( "lseek failed" ); }
+
+      // ENXIO : nothing but a hole up to the end
+      std::uint64_t const dataStart( data < 0 ? fileSize
+                                               : std::min< std::uint64_t >( fileSize, data ) );
+      hasher.updateZeros( dataStart - offset );
+      offset = dataStart;
+      if( offset == fileSize ) { break; }
+
+      off_t const hole( ::lseek( fd, static_cast< off_t >( offset ), SEEK_HOLE ) );
+      if( hole < 0 ) { throw fileError( "lseek failed" ); }
+      std::uint64_t dataEnd( std::min< std::uint64_t >( fileSize, hole ) );
+      if( dataEnd <= offset ) { dataEnd = fileSize; }   // changed meanwhile : read the rest
+
+      std::uint64_t const done( options.forceRead ? offset
+                                                  : hashMapped( hasher, fd, offset, dataEnd,
+                                                                options ) );
+      hashPread( hasher, fd, done, dataEnd, options );
+      offset = dataEnd;
+   }
+#else
+   hashPread( hasher, fd, 0, fileSize, options );
+#endif
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Page aligned buffer of a ReadRing.
+ */
+struct AlignedDelete
+{
+   void operator () ( std::uint8_t* data ) const
+   {
+      ::operator delete( data, std::align_val_t( 4096 ) );
+   }
+};
+
+typedef std::unique_ptr< std::uint8_t[], AlignedDelete > AlignedBuffer;
+
+inline AlignedBuffer
+makeAlignedBuffer( std::size_t size )
+{
+   return AlignedBuffer( static_cast< std::uint8_t* >(
+                            ::operator new( size, std::align_val_t( 4096 ) ) ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Lock free single producer, single consumer ring of read buffers.
+ *
+ *  The reader fills slot tail % slots and publishes it by moving tail, the
+ *  hasher consumes slot head % slots and gives it back by moving head.  Each
+ *  index is written by one thread only : the release / acquire pair on it
+ *  is the whole synchronization.  A slot published with a length of 0 marks
+ *  the end of the file, error_ tells whether it ended on a read error.
+ *
+ *  A side that has to wait spins briefly, then sleeps on a condition
+ *  variable.  The other side only takes the mutex to wake it when it counts
+ *  as a sleeper, so the handoff stays lock free while neither side waits.
+ */
+class ReadRing
+{
+public:
+   ReadRing( std::size_t nbOfSlots, std::size_t slotSize )
+      : slotSize_( slotSize ), lens_( nbOfSlots ), head_( 0 ), tail_( 0 ),
+        stopped_( false ), error_( 0 ), sleepers_( 0 )
+   {
+      for( std::size_t slot( 0 ); slot != nbOfSlots; ++slot )
+      {
+         buffers_.push_back( makeAlignedBuffer( slotSize ) );
+      }
+   }
+
+   std::size_t slotSize() const { return slotSize_; }
+
+   //! Producer : next free buffer, null once the consumer stopped.
+   std::uint8_t* acquireFree( std::chrono::nanoseconds& stalled )
+   {
+      std::size_t const tail( tail_.load( std::memory_order_relaxed ) );
+      waitFor( [&]() { return tail - head_.load( std::memory_order_acquire ) < buffers_.size() ||
+                              stopped_.load( std::memory_order_relaxed ); }, stalled );
+      if( stopped_.load( std::memory_order_relaxed ) ) { return nullptr; }
+      return buffers_[tail % buffers_.size()].get();
+   }
+
+   //! Producer : hand the buffer over, a length of 0 ends the stream.
+   void publish( std::size_t len, int error = 0 )
+   {
+      std::size_t const tail( tail_.load( std::memory_order_relaxed ) );
+      lens_[tail % buffers_.size()] = len;
+      error_ = error;
+      tail_.store( tail + 1, std::memory_order_release );
+      wake();
+   }
+
+   //! Consumer : next filled buffer and its length.
+   std::uint8_t const* acquireFilled( std::size_t& len, std::chrono::nanoseconds& stalled )
+   {
+      std::size_t const head( head_.load( std::memory_order_relaxed ) );
+      waitFor( [&]() { return tail_.load( std::memory_order_acquire ) != head; }, stalled );
+      len = lens_[head % buffers_.size()];
+      return buffers_[head % buffers_.size()].get();
+   }
+
+   //! Consumer : give the buffer back to the producer.
+   void release()
+   {
+      head_.store( head_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+      wake();
+   }
+
+   //! Consumer : make the producer give up.
+   void stop()
+   {
+      stopped_.store( true, std::memory_order_relaxed );
+      wake();
+   }
+
+   //! Error the stream ended on, valid after the last slot was acquired.
+   int error() const { return error_; }
+
+private:
+   //! Wait until ready() is true, adding the time it took to stalled.
+   template< typename Ready >
+   void waitFor( Ready const& ready, std::chrono::nanoseconds& stalled )
+   {
+      if( ready() ) { return; }
+
+      // The other side usually hands a buffer over within microseconds when
+      // it is not the bottleneck : yield a few times before sleeping
+      constexpr int spins( 64 );
+      auto const start( std::chrono::steady_clock::now() );
+      int spin( 0 );
+      for( ; spin != spins && !ready(); ++spin ) { std::this_thread::yield(); }
+      if( spin == spins )
+      {
+         std::unique_lock< std::mutex > lock( mutex_ );
+         sleepers_.fetch_add( 1, std::memory_order_relaxed );
+         std::atomic_thread_fence( std::memory_order_seq_cst );
+         changed_.wait( lock, ready );
+         sleepers_.fetch_sub( 1, std::memory_order_relaxed );
+      }
+      stalled += std::chrono::steady_clock::now() - start;
+   }
+
+   //! Wake the other side if it sleeps, after moving an index.
+   void wake()
+   {
+      // Pairs with the fence of waitFor : either the sleeper sees the new
+      // index, or this sees the sleeper
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      if( sleepers_.load( std::memory_order_relaxed ) == 0 ) { return; }
+      { std::lock_guard< std::mutex > lock( mutex_ ); }
+      changed_.notify_all();
+   }
+
+   std::size_t slotSize_;
+   std::vector< AlignedBuffer > buffers_;
+   std::vector< std::size_t > lens_;
+   alignas( 64 ) std::atomic< std::size_t > head_;
+   alignas( 64 ) std::atomic< std::size_t > tail_;
+   std::atomic< bool > stopped_;
+   int error_;
+
+   std::mutex mutex_;
+   std::condition_variable changed_;
+   std::atomic< unsigned > sleepers_;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Reader thread : fill the ring until the end of the file.
+ *
+ *  Buffers are filled completely unless the file ends, so the hasher always
+ *  gets whole chunks straight to the kernel.
+ */
+inline void
+readIntoRing( ReadRing& ring, int fd, std::chrono::nanoseconds& stalled )
+{
+   for( ;; )
+   {
+      std::uint8_t* buffer( ring.acquireFree( stalled ) );
+      if( buffer == nullptr ) { return; }
+
+      std::size_t filled( 0 );
+      while( filled != ring.slotSize() )
+      {
+         ssize_t const got( ::read( fd, buffer + filled, ring.slotSize() - filled ) );
+         if( got == 0 ) { break; }
+         if( got < 0 )
+         {
+            if( errno == EINTR ) { continue; }
+            ring.publish( 0, errno );
+            return;
+         }
+         filled += static_cast< std::size_t >( got );
+      }
+
+      if( filled == 0 )
+      {
+         ring.publish( 0 );
+         return;
+      }
+      ring.publish( filled );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief O_DIRECT set on a file descriptor while the object lives.
+ */
+struct DirectMode
+{
+   explicit DirectMode( int fd )
+      : fd_( fd ), flags_( ::fcntl( fd, F_GETFL ) ), set_( false ), active_( false )
+   {
+#ifdef O_DIRECT
+      if( flags_ < 0 ) { return; }
+      if( !( flags_ & O_DIRECT ) ) { set_ = ::fcntl( fd, F_SETFL, flags_ | O_DIRECT ) == 0; }
+      active_ = ( flags_ & O_DIRECT ) || set_;
+#endif
+   }
+   ~DirectMode() { if( set_ ) { ::fcntl( fd_, F_SETFL, flags_ ); } }
+
+   DirectMode( DirectMode const& ) = delete;
+   DirectMode& operator = ( DirectMode const& ) = delete;
+
+   int fd_;
+   int flags_;
+   bool set_;
+   bool active_;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Drops the pages of a file from the page cache as they are hashed.
+ *
+ *  The cache holds files in folios of up to a huge page, and
+ *  POSIX_FADV_DONTNEED only drops the folios entirely within its range : each
+ *  call starts back at the huge page the previous one ended in.  The whole
+ *  file is dropped once more at the end, readahead included.  Does nothing
+ *  for a negative fd.
+ */
+struct CacheDropper
+{
+   explicit CacheDropper( int fd ) : fd_( fd ), from_( 0 ) {}
+   ~CacheDropper() { drop( 0, 0 ); }
+
+   CacheDropper( CacheDropper const& ) = delete;
+   CacheDropper& operator = ( CacheDropper const& ) = delete;
+
+   void hashedUpTo( std::uint64_t end )
+   {
+      drop( from_, end - from_ );
+      from_ = end / FileOptions::huge_page_size * FileOptions::huge_page_size;
+   }
+
+   void drop( std::uint64_t offset, std::uint64_t len ) const
+   {
+#ifdef POSIX_FADV_DONTNEED
+      if( fd_ < 0 ) { return; }
+      ::posix_fadvise( fd_, static_cast< off_t >( offset ), static_cast< off_t >( len ),
+                       POSIX_FADV_DONTNEED );
+#else
+      static_cast< void >( offset ); static_cast< void >( len );
+#endif
+   }
+
+   int fd_;
+   std::uint64_t from_;
+};
+
+
+
+#if HDQRT_IO_URING
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash the first fileSize bytes of a regular file with up to depth
+ *         io_uring reads in flight.
+ *
+ *  Read k goes to buffer k % depth, and buffers are hashed in file order as
+ *  soon as the one at the front completes, then reused for the next read.
+ *  With O_DIRECT, the length of the last read is rounded up to the
+ *  alignment : the kernel returns the unaligned tail.  Short reads are
+ *  completed, a read returning 0 means the file shrank and ends the hash.
+ */
+template< typename Algo >
+inline void
+hashUncachedUring( Hasher<Algo>& hasher, int fd, std::uint64_t fileSize,
+                   std::size_t bufferSize, std::size_t depth, bool direct,
+                   CacheDropper& dropper )
+{
+   constexpr std::size_t align( FileOptions::direct_alignment );
+
+   struct Read
+   {
+      AlignedBuffer buffer;
+      std::uint64_t offset;
+      std::size_t wanted;
+      std::size_t filled;
+      bool done;
+   };
+   std::vector< Read > reads( static_cast< std::size_t >( std::min< std::uint64_t >(
+                                    depth, ( fileSize + bufferSize - 1 ) / bufferSize ) ) );
+   for( Read& read : reads ) { read.buffer = makeAlignedBuffer( bufferSize ); }
+
+   // After the buffers : destroyed first, with no read left in flight
+   IoUring ring( static_cast< unsigned >( reads.size() ) );
+   if( !ring.valid() ) { throw fileError( "io_uring setup failed" ); }
+
+   std::uint64_t end( fileSize );
+   std::uint64_t nextOffset( 0 );
+   std::size_t started( 0 ), hashed( 0 ), inFlight( 0 );
+   int error( 0 );
+
+   auto submit = [&]( std::size_t slot )
+   {
+      Read& read( reads[slot] );
+      std::size_t len( read.wanted - read.filled );
+      if( direct ) { len = ( len + align - 1 ) / align * align; }
+
+      io_uring_sqe* sqe( ring.nextSqe() );
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast< std::uint64_t >( read.buffer.get() + read.filled );
+      sqe->len = static_cast< unsigned >( len );
+      sqe->off = read.offset + read.filled;
+      sqe->user_data = slot;
+      ++inFlight;
+   };
+
+   auto start = [&]( std::size_t slot )
+   {
+      if( nextOffset >= end || error != 0 ) { return; }
+      Read& read( reads[slot] );
+      read.offset = nextOffset;
+      read.wanted = static_cast< std::size_t >( std::min< std::uint64_t >(
+                                                   bufferSize, end - nextOffset ) );
+      read.filled = 0;
+      read.done = false;
+      nextOffset += read.wanted;
+      ++started;
+      submit( slot );
+   };
+
+   auto complete = [&]( std::uint64_t slot, int res )
+   {
+      --inFlight;
+      Read& read( reads[slot] );
+      if( res == -EINTR || res == -EAGAIN )
+      {
+         if( error == 0 ) { submit( slot ); }
+         return;
+      }
+      if( res < 0 )
+      {
+         if( error == 0 ) { error = -res; }
+         read.done = true;
+         return;
+      }
+
+      read.filled = std::min( read.wanted, read.filled + static_cast< std::size_t >( res ) );
+      if( res == 0 || read.filled == read.wanted ) { read.done = true; }
+      else if( error == 0 ) { submit( slot ); }
+   };
+
+   for( std::size_t slot( 0 ); slot != reads.size(); ++slot ) { start( slot ); }
+
+   while( inFlight != 0 )
+   {
+      ring.submit( 1 );
+      ring.reap( complete );
+
+      while( error == 0 && hashed != started && reads[hashed % reads.size()].done )
+      {
+         std::size_t const slot( hashed % reads.size() );
+         Read& read( reads[slot] );
+         hasher.update( read.buffer.get(), read.filled );
+         dropper.hashedUpTo( read.offset + read.filled );
+         ++hashed;
+
+         if( read.filled != read.wanted ) { end = read.offset + read.filled; }
+         start( slot );
+      }
+   }
+
+   if( error != 0 )
+   {
+      errno = error;
+      throw fileError( "read failed" );
+   }
+}
+#endif // HDQRT_IO_URING
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a regular file around the page cache.
+ *
+ *  With options.direct, reads bypass the cache with O_DIRECT.  Otherwise, or
+ *  when the file system refuses O_DIRECT, they go through the cache and
+ *  each range is dropped from it once hashed.  options.queueDepth reads are
+ *  kept in flight with io_uring; without it, a reader thread fills a ring of
+ *  that many buffers ahead of the hasher.
+ */
+template< typename Algo >
+inline void
+hashUncached( Hasher<Algo>& hasher, int fd, std::uint64_t fileSize,
+              FileOptions const& options )
+{
+   constexpr std::size_t align( FileOptions::direct_alignment );
+   std::size_t const bufferSize( std::max( align, options.bufferSize / align * align ) );
+   std::size_t const depth( std::max< std::size_t >( 1, options.queueDepth ) );
+
+   DirectMode directMode( options.direct ? fd : -1 );
+   bool const direct( options.direct && directMode.active_ );
+   CacheDropper dropper( direct ? -1 : fd );
+
+#if HDQRT_IO_URING
+   if( ioUringAvailable() )
+   {
+      if( fileSize != 0 )
+      {
+         hashUncachedUring( hasher, fd, fileSize, bufferSize, depth, direct, dropper );
+      }
+      return;
+   }
+#endif
+
+   if( ::lseek( fd, 0, SEEK_SET ) < 0 ) { throw fileError( "lseek failed" ); }
+
+   ReadRing ring( std::max< std::size_t >( 2, depth ), bufferSize );
+   std::chrono::nanoseconds readerStalled( 0 ), hasherStalled( 0 );
+   std::thread reader( [&]() { readIntoRing( ring, fd, readerStalled ); } );
+
+   std::uint64_t offset( 0 );
+   for( ;; )
+   {
+      std::size_t len( 0 );
+      std::uint8_t const* data( ring.acquireFilled( len, hasherStalled ) );
+      if( len == 0 ) { break; }
+
+      hasher.update( data, len );
+      offset += len;
+      dropper.hashedUpTo( offset );
+      ring.release();
+   }
+   ring.stop();
+   reader.join();
+
+   if( ring.error() != 0 )
+   {
+      errno = ring.error();
+      throw fileError( "read failed" );
+   }
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash the content of an open file with I/O and hashing overlapped.
+ *
+ *  A reader thread fills a ring of options.ringSlots page aligned buffers of
+ *  options.bufferSize bytes while the calling thread hashes the filled ones,
+ *  so the disk and the core work at the same time.  Reads start from the
+ *  current position for pipes and devices, from the start for regular files.
+ *  stats receives the byte count and how long each side waited on the other.
+ *
+ *  fd is left open.  Throws std::system_error when reading fails.
+ */
+template< typename Algo >
+inline void
+hashFilePipelined( int fd, Digest<Algo>& digest, PipelineStats& stats,
+                   FileOptions const& options )
+{
+   constexpr std::size_t chunkBytes( Hasher<Algo>::chunk_bytes );
+
+   struct stat info;
+   if( ::fstat( fd, &info ) != 0 ) { throw details::fileError( "fstat failed" ); }
+   if( S_ISREG( info.st_mode ) )
+   {
+      if( ::lseek( fd, 0, SEEK_SET ) < 0 ) { throw details::fileError( "lseek failed" ); }
+#ifdef POSIX_FADV_SEQUENTIAL
+      ::posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+   }
+
+   details::ReadRing ring( std::max< std::size_t >( 2, options.ringSlots ),
+                           std::max( chunkBytes, options.bufferSize / chunkBytes * chunkBytes ) );
+
+   stats = PipelineStats();
+   std::thread reader( [&]() { details::readIntoRing( ring, fd, stats.readerStalled ); } );
+
+   Hasher<Algo> hasher;
+   for( ;; )
+   {
+      std::size_t len( 0 );
+      std::uint8_t const* data( ring.acquireFilled( len, stats.hasherStalled ) );
+      if( len == 0 ) { break; }
+
+      hasher.update( data, len );
+      stats.bytes += len;
+      ring.release();
+   }
+   ring.stop();
+   reader.join();
+
+   if( ring.error() != 0 )
+   {
+      errno = ring.error();
+      throw details::fileError( "read failed" );
+   }
+   hasher.finalize( digest );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash the content of an open file, from its current position for
+ *         pipes and devices, from its start for regular files.
+ *
+ *  Regular files are mapped unless options ask for the read() loop, for the
+ *  pipelined reader, or to keep the file out of the page cache.  The holes
+ *  of sparse files are not read, unless options.skipHoles is false.  fd is
+ *  left open.  Throws std::system_error when reading fails.
+ */
+template< typename Algo >
+inline void
+hashFile( int fd, Digest<Algo>& digest, FileOptions const& options )
+{
+   struct stat info;
+   if( ::fstat( fd, &info ) != 0 ) { throw details::fileError( "fstat failed" ); }
+
+   if( ( options.direct || options.dropCache ) && S_ISREG( info.st_mode ) )
+   {
+      Hasher<Algo> hasher;
+      details::hashUncached( hasher, fd, static_cast< std::uint64_t >( info.st_size ), options );
+      hasher.finalize( digest );
+      return;
+   }
+
+   if( options.pipelined )
+   {
+      PipelineStats stats;
+      hashFilePipelined<Algo>( fd, digest, stats, options );
+      return;
+   }
+
+   Hasher<Algo> hasher;
+
+   if( S_ISREG( info.st_mode ) && options.skipHoles && details::hasHoles( fd, info ) )
+   {
+      details::hashSparse( hasher, fd, static_cast< std::uint64_t >( info.st_size ), options );
+      hasher.finalize( digest );
+      return;
+   }
+
+   if( S_ISREG( info.st_mode ) && !options.forceRead && info.st_size > 0 )
+   {
+      std::uint64_t const fileSize( static_cast< std::uint64_t >( info.st_size ) );
+      std::uint64_t const done( details::hashMapped( hasher, fd, 0, fileSize, options ) );
+      if( done == fileSize )
+      {
+         hasher.finalize( digest );
+         return;
+      }
+
+      if( ::lseek( fd, static_cast< off_t >( done ), SEEK_SET ) < 0 )
+      {
+         throw details::fileError( "lseek failed" );
+      }
+   }
+   else if( S_ISREG( info.st_mode ) && ::lseek( fd, 0, SEEK_SET ) < 0 )
+   {
+      throw details::fileError( "lseek failed" );
+   }
+
+   details::hashRead( hasher, fd, options );
+   hasher.finalize( digest );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a file without loading it in memory.
+ *
+ *  Throws std::system_error when the file cannot be opened or read.
+ */
+template< typename Algo >
+inline void
+hashFile( std::string const& path, Digest<Algo>& digest, FileOptions const& options )
+{
+   details::FileDescriptor file( ::open( path.c_str(), O_RDONLY | O_CLOEXEC ) );
+   if( file.fd_ < 0 ) { throw details::fileError( "cannot open " + path ); }
+
+   hashFile<Algo>( file.fd_, digest, options );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hex digest of a file.  See hashFile( path, digest, options ).
+ */
+template< typename Algo >
+inline std::string
+hashFile( std::string const& path, FileOptions const& options )
+{
+   Digest<Algo> digest;
+   hashFile<Algo>( path, digest, options );
+   return digest.hex();
+}
+
+} // namespace hashes
@@ -0,0 +1,66 @@
+#ifndef HDQRT_HASH_FILEBATCH_H_
+#define HDQRT_HASH_FILEBATCH_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <string>
+#include <vector>
+
+#include "File.h"
+
+
+#if HDQRT_POSIX_FILES
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief How hashFiles works through a list of files.
+ */
+struct BatchOptions
+{
+   /*! Files open at the same time : operations in flight with io_uring,
+    *  threads of the fallback pool. */
+   std::size_t queueDepth = 256;
+
+   /*! Read buffer of each file in flight, rounded down to whole chunks. */
+   std::size_t bufferSize = std::size_t( 1 ) << 16;
+
+   /*! Threads hashing the buffers io_uring completes.  With 0, the thread
+    *  driving the ring hashes them itself, which is best for small files. */
+   std::size_t workers = 0;
+
+   /*! Use the thread pool even when io_uring is available. */
+   bool forceThreadPool = false;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Digest of one file of a batch.
+ */
+template< typename Algo >
+struct FileResult
+{
+   Digest<Algo> digest;
+
+   /*! errno of the open or read that failed, 0 when digest is valid. */
+   int error = 0;
+};
+
+
+template< typename Algo >
+std::vector< FileResult<Algo> >
+hashFiles( std::vector< std::string > const& paths,
+           BatchOptions const& options = BatchOptions() );
+
+
+} // namespace hashes
+
+#include "FileBatch.inl"
+
+#endif // HDQRT_POSIX_FILES
+
+#endif // HDQRT_HASH_FILEBATCH_H_
@@ -0,0 +1,420 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace hashes
+{
+
+namespace details
+{
+
+#if HDQRT_IO_URING
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One file in flight in the io_uring engine.
+ *
+ *  A slot has at most one operation in the ring, or is being hashed, never
+ *  both : whoever holds it is the only one touching it.  fd is -1 while no
+ *  file is open through it.
+ */
+template< typename Algo >
+struct UringSlot
+{
+   enum class Stage { OPEN, READ, CLOSE };
+
+   std::size_t file;
+   int fd;
+   std::uint64_t offset;
+   std::size_t len;
+   Stage stage;
+   Hasher<Algo> hasher;
+   AlignedBuffer buffer;
+};
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a list of files with io_uring.
+ *
+ *  Up to queueDepth files are opened, read and closed through the ring, each
+ *  with its own buffer.  Completed reads are hashed by the thread driving the
+ *  ring, or handed to the workers which queue the next read themselves.  The
+ *  reads go on until one returns 0, so a short read is never mistaken for the
+ *  end of the file.  On an exception, here or on a worker, nothing more is
+ *  queued : the operations in flight are waited for and the files still
+ *  open are closed before it is rethrown by the driving thread.
+ */
+template< typename Algo >
+inline void
+hashFilesUring( IoUring& ring, std::vector< std::string > const& paths,
+                std::vector< FileResult<Algo> >& results, BatchOptions const& options )
+{
+   typedef UringSlot<Algo> Slot;
+   typedef typename Slot::Stage Stage;
+   constexpr std::size_t chunkBytes( Hasher<Algo>::chunk_bytes );
+
+   std::size_t const bufferSize( std::max( chunkBytes,
+                                           options.bufferSize / chunkBytes * chunkBytes ) );
+   std::vector< Slot > slots( std::min< std::size_t >(
+                                 { options.queueDepth, paths.size(), ring.entries() } ) );
+   for( Slot& slot : slots )
+   {
+      slot.fd = -1;
+      slot.buffer = makeAlignedBuffer( bufferSize );
+   }
+
+   std::mutex sqMutex;
+   std::size_t nextFile( 0 ), done( 0 );
+
+   auto queue = [&]( std::size_t slotIdx )
+   {
+      Slot& slot( slots[slotIdx] );
+      io_uring_sqe* sqe( ring.nextSqe() );
+      sqe->user_data = slotIdx;
+      switch( slot.stage )
+      {
+         case Stage::OPEN:
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast< std::uint64_t >( paths[slot.file].c_str() );
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            break;
+         case Stage::READ:
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = slot.fd;
+            sqe->addr = reinterpret_cast< std::uint64_t >( slot.buffer.get() );
+            sqe->len = static_cast< unsigned >( bufferSize );
+            sqe->off = slot.offset;
+            break;
+         case Stage::CLOSE:
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = slot.fd;
+            break;
+      }
+   };
+
+   auto startNext = [&]( std::size_t slotIdx )
+   {
+      if( nextFile == paths.size() ) { return; }
+      Slot& slot( slots[slotIdx] );
+      slot.file = nextFile++;
+      slot.stage = Stage::OPEN;
+      queue( slotIdx );
+   };
+
+   // Hashing workers : hash the buffer, then queue the next read
+   std::mutex workMutex;
+   std::condition_variable workReady;
+   std::deque< std::size_t > work;
+   bool stopping( false );
+   std::vector< std::thread > workers;
+
+   // First error of any thread, guarded by sqMutex : once set, nothing more
+   // is queued.  A worker that fails queues a no-op with this user_data to
+   // wake the driving thread.
+   std::exception_ptr error;
+   std::uint64_t const wakeUp( slots.size() );
+
+   auto hashAndContinue = [&]( std::size_t slotIdx, bool locked )
+   {
+      Slot& slot( slots[slotIdx] );
+      slot.hasher.update( slot.buffer.get(), slot.len );
+      slot.offset += slot.len;
+      if( locked ) { queue( slotIdx ); return; }
+
+      std::lock_guard< std::mutex > lock( sqMutex );
+      if( error ) { return; }
+      queue( slotIdx );
+      ring.submit( 0 );
+   };
+
+   struct Joiner
+   {
+      ~Joiner() { join(); }
+      void join()
+      {
+         { std::lock_guard< std::mutex > lock( mutex ); stop = true; }
+         ready.notify_all();
+         for( std::thread& worker : threads )
+         {
+            if( worker.joinable() ) { worker.join(); }
+         }
+      }
+      std::mutex& mutex;
+      std::condition_variable& ready;
+      bool& stop;
+      std::vector< std::thread >& threads;
+   } joiner{ workMutex, workReady, stopping, workers };
+
+   for( std::size_t idx( 0 ); idx != options.workers; ++idx )
+   {
+      workers.emplace_back( [&]()
+      {
+         for( ;; )
+         {
+            std::size_t slotIdx;
+            {
+               std::unique_lock< std::mutex > lock( workMutex );
+               workReady.wait( lock, [&]() { return stopping || !work.empty(); } );
+               if( work.empty() ) { return; }
+               slotIdx = work.front();
+               work.pop_front();
+            }
+            try
+            {
+               hashAndContinue( slotIdx, false );
+            }
+            catch( ... )
+            {
+               std::lock_guard< std::mutex > lock( sqMutex );
+               if( !error ) { error = std::current_exception(); }
+               try
+               {
+                  io_uring_sqe* sqe( ring.nextSqe() );
+                  sqe->opcode = IORING_OP_NOP;
+                  sqe->user_data = wakeUp;
+                  ring.submit( 0 );
+               }
+               catch( ... ) {}
+            }
+         }
+      } );
+   }
+
+   auto complete = [&]( std::uint64_t slotIdx, int res )
+   {
+      if( slotIdx == wakeUp ) { return; }
+      Slot& slot( slots[slotIdx] );
+      FileResult<Algo>& result( results[slot.file] );
+      switch( slot.stage )
+      {
+         case Stage::OPEN:
+            if( res < 0 )
+            {
+               result.error = -res;
+               ++done;
+               startNext( slotIdx );
+               return;
+            }
+            slot.fd = res;
+            slot.offset = 0;
+            slot.hasher.reset();
+            slot.stage = Stage::READ;
+            queue( slotIdx );
+            return;
+
+         case Stage::READ:
+            if( res > 0 )
+            {
+               slot.len = static_cast< std::size_t >( res );
+               if( workers.empty() ) { hashAndContinue( slotIdx, true ); return; }
+               {
+                  std::lock_guard< std::mutex > lock( workMutex );
+                  work.push_back( slotIdx );
+               }
+               workReady.notify_one();
+               return;
+            }
+            if( res < 0 ) { result.error = -res; }
+            else          { slot.hasher.finalize( result.digest ); }
+            slot.stage = Stage::CLOSE;
+            queue( slotIdx );
+            return;
+
+         case Stage::CLOSE:
+            slot.fd = -1;
+            ++done;
+            startNext( slotIdx );
+            return;
+      }
+   };
+
+   // Only follows the fds : nothing is queued any more
+   auto drained = [&]( std::uint64_t slotIdx, int res )
+   {
+      if( slotIdx == wakeUp ) { return; }
+      Slot& slot( slots[slotIdx] );
+      if( slot.stage == Stage::OPEN && res >= 0 ) { slot.fd = res; }
+      if( slot.stage == Stage::CLOSE ) { slot.fd = -1; }
+   };
+
+   try
+   {
+      {
+         std::lock_guard< std::mutex > lock( sqMutex );
+         for( std::size_t slotIdx( 0 ); slotIdx != slots.size(); ++slotIdx )
+         {
+            startNext( slotIdx );
+         }
+      }
+
+      while( done != paths.size() )
+      {
+         if( workers.empty() )
+         {
+            ring.submit( 1 );
+            ring.reap( complete );
+            continue;
+         }
+
+         // The workers submit under sqMutex : waiting must not touch the
+         // submission queue
+         {
+            std::lock_guard< std::mutex > lock( sqMutex );
+            if( error ) { std::rethrow_exception( error ); }
+            ring.submit( 0 );
+         }
+         ring.wait( 1 );
+         std::lock_guard< std::mutex > lock( sqMutex );
+         ring.reap( complete );
+         if( error ) { std::rethrow_exception( error ); }
+      }
+   }
+   catch( ... )
+   {
+      {
+         std::lock_guard< std::mutex > lock( sqMutex );
+         if( !error ) { error = std::current_exception(); }
+      }
+      joiner.join();
+
+      // The kernel may still read into the buffers and open files : wait for
+      // every operation it took.  If even that fails, leak the buffers rather
+      // than free memory it may write into.
+      try
+      {
+         while( ring.inFlight() != 0 )
+         {
+            ring.wait( 1 );
+            ring.reap( drained );
+         }
+      }
+      catch( ... )
+      {
+         for( Slot& slot : slots ) { slot.buffer.release(); }
+      }
+
+      for( Slot& slot : slots )
+      {
+         if( slot.fd >= 0 ) { ::close( slot.fd ); }
+      }
+      std::rethrow_exception( error );
+   }
+}
+#endif // HDQRT_IO_URING
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash a list of files with a pool of blocking threads.
+ *
+ *  One thread per file in flight : each takes the next file of the list,
+ *  reads it through its own buffer and hashes it.  Fewer threads run when
+ *  the system refuses to create them all.
+ */
+template< typename Algo >
+inline void
+hashFilesPool( std::vector< std::string > const& paths,
+               std::vector< FileResult<Algo> >& results, BatchOptions const& options )
+{
+   constexpr std::size_t chunkBytes( Hasher<Algo>::chunk_bytes );
+   std::size_t const bufferSize( std::max( chunkBytes,
+                                           options.bufferSize / chunkBytes * chunkBytes ) );
+   std::atomic< std::size_t > nextFile( 0 );
+
+   auto run = [&]()
+   {
+      std::vector< std::uint8_t > buffer( bufferSize );
+      Hasher<Algo> hasher;
+      for( std::size_t file( nextFile++ ); file < paths.size(); file = nextFile++ )
+      {
+         FileDescriptor in( ::open( paths[file].c_str(), O_RDONLY | O_CLOEXEC ) );
+         if( in.fd_ < 0 )
+         {
+            results[file].error = errno;
+            continue;
+         }
+
+         hasher.reset();
+         for( ;; )
+         {
+            ssize_t const got( ::read( in.fd_, buffer.data(), buffer.size() ) );
+            if( got > 0 ) { hasher.update( buffer.data(), static_cast< std::size_t >( got ) ); }
+            else if( got == 0 ) { hasher.finalize( results[file].digest ); break; }
+            else if( errno != EINTR ) { results[file].error = errno; break; }
+         }
+      }
+   };
+
+   std::vector< std::thread > threads;
+   std::size_t const nbOfThreads( std::min( std::max< std::size_t >( 1, options.queueDepth ),
+                                            paths.size() ) );
+   threads.reserve( nbOfThreads );
+   try
+   {
+      for( std::size_t idx( 1 ); idx < nbOfThreads; ++idx ) { threads.emplace_back( run ); }
+   }
+   catch( std::system_error const& )
+   {
+      // Out of threads, as under a pids cgroup limit : go on with those started
+   }
+   run();
+   for( std::thread& thread : threads ) { thread.join(); }
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hash many files, keeping many of them in flight at once.
+ *
+ *  Meant for large numbers of small files, where the cost is in the system
+ *  calls and in waiting on each open and read rather than in the rounds.
+ *  Uses io_uring when available, a thread pool otherwise.  Returns one
+ *  result per path, in the same order.  A file that cannot be opened or read
+ *  gets its errno in FileResult::error, the others are not affected.
+ */
+template< typename Algo >
+inline std::vector< FileResult<Algo> >
+hashFiles( std::vector< std::string > const& paths, BatchOptions const& options )
+{
+   std::vector< FileResult<Algo> > results( paths.size() );
+   if( paths.empty() ) { return results; }
+
+#if HDQRT_IO_URING
+   if( !options.forceThreadPool && ioUringAvailable() )
+   {
+      unsigned const entries( static_cast< unsigned >(
+                        std::min< std::size_t >( std::max< std::size_t >( 1, options.queueDepth ),
+                                                 4096 ) ) );
+      details::IoUring ring( entries );
+      if( ring.valid() )
+      {
+         details::hashFilesUring<Algo>( ring, paths, results, options );
+         return results;
+      }
+   }
+#endif
+
+   details::hashFilesPool<Algo>( paths, results, options );
+   return results;
+}
+
+} // namespace hashes
@@ -4,6 +4,8 @@
 #include <string>
 #include <cstddef> // for std::size_t
 
+#include "../bits.h"
+
 namespace hashes
 {
 
@@ -13,13 +15,14 @@ namespace hashes
  *
  *  A hash algorithm must define the following
  *    - word_t
+ *
+ *  It can override byte_order, the order of the bytes of the message words,
+ *  of the length and of the digest.
  */
 struct HashBase
-{};
-
-
-template< typename Algo >
-void padLastChunk( std::string& msg, std::size_t origMsgLen );
+{
+   static constexpr bits::Endianness byte_order = bits::Endianness::BIG;
+};
 
 
 } // namespace hashes
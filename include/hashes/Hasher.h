@@ -0,0 +1,71 @@
+#ifndef HDQRT_HASH_HASHER_H_
+#define HDQRT_HASH_HASHER_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <climits> // for CHAR_BIT
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "../hashes.h"
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Incremental hashing of a message received in pieces.
+ *
+ *  Wraps a Hash<Algo> and keeps the bytes that do not yet fill a whole chunk
+ *  in an internal one chunk buffer.  update() can be called as many times as
+ *  needed and finalize() pads the message, returns the digest and resets the
+ *  hasher so that it can be reused for the next message.
+ *
+ *  The digest is identical to the one hashStrg<Algo> returns for the
+ *  concatenation of all the updates.
+ *
+ *  A hasher holding a common prefix is a snapshot of it : fork() and
+ *  finalizeWith() finish messages from there without hashing the prefix
+ *  again.  finalizeWith() is const, so threads can share one snapshot.
+ */
+template< typename Algo >
+class Hasher
+{
+public:
+   typedef typename Algo::word_t word_t;
+
+   static constexpr std::size_t chunk_bytes = Algo::chunk_size / CHAR_BIT;
+   static constexpr std::size_t len_bytes = Algo::len_encode_len / CHAR_BIT;
+
+   Hasher();
+
+   void reset();
+   void reset( typename Hash<Algo>::hash_type const& midstate, std::uint64_t length );
+
+   Hasher& update( void const* data, std::size_t size );
+   Hasher& update( std::string_view data );
+   Hasher& updateZeros( std::uint64_t count );
+
+   std::string finalize();
+   void finalize( Digest<Algo>& digest );
+
+   Hasher fork() const;
+   std::string finalizeWith( std::string_view suffix ) const;
+   void finalizeWith( void const* suffix, std::size_t size, Digest<Algo>& digest ) const;
+
+   std::uint64_t length() const;
+
+private:
+   Hash<Algo> hash_;
+   std::array< std::uint8_t, chunk_bytes > buffer_;
+   std::size_t bufferLen_;
+   std::uint64_t msgLen_;
+};
+
+
+} // namespace hashes
+
+#include "Hasher.inl"
+
+#endif // HDQRT_HASH_HASHER_H_
@@ -0,0 +1,284 @@
+#include <cstring> // for std::memcpy and std::memset
+#include <algorithm>
+
+#include "../always_inline.h"
+
+namespace hashes
+{
+
+template< typename Algo >
+constexpr std::size_t Hasher<Algo>::chunk_bytes;
+
+template< typename Algo >
+constexpr std::size_t Hasher<Algo>::len_bytes;
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline Hasher<Algo>::Hasher()
+{
+   reset();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Drop any data received so far and start a new message.
+ */
+template< typename Algo >
+inline void Hasher<Algo>::reset()
+{
+   initializeHash<Algo>( hash_ );
+   bufferLen_ = 0;
+   msgLen_ = 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Start a new message from the state reached after its first length
+ *         bytes, which must be a whole number of chunks.
+ *
+ *  The rest of the message is then added with update() as usual.
+ */
+template< typename Algo >
+inline void Hasher<Algo>::reset( typename Hash<Algo>::hash_type const& midstate,
+                                 std::uint64_t length )
+{
+   hash_.state = midstate;
+   bufferLen_ = 0;
+   msgLen_ = length;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Add data to the message.
+ *
+ *  Whole chunks are processed straight from the input.  Only the bytes that
+ *  complete the previously buffered data or that are left over at the end are
+ *  copied to the internal buffer.
+ */
+template< typename Algo >
+inline Hasher<Algo>& Hasher<Algo>::update( void const* data, std::size_t size )
+{
+   auto input = static_cast< std::uint8_t const* >( data );
+   msgLen_ += size;
+
+   // Complete a partially filled buffer first
+   if( bufferLen_ != 0 )
+   {
+      std::size_t toCopy( std::min( size, chunk_bytes - bufferLen_ ) );
+      std::memcpy( buffer_.data() + bufferLen_, input, toCopy );
+      bufferLen_ += toCopy;
+      input += toCopy;
+      size -= toCopy;
+
+      if( bufferLen_ != chunk_bytes ) { return *this; }
+
+      processChunk<Algo>( hash_, buffer_.data() );
+      bufferLen_ = 0;
+   }
+
+   std::size_t nbOfChunks( size / chunk_bytes );
+   processBlocks<Algo>( hash_.state, input, nbOfChunks );
+   input += nbOfChunks * chunk_bytes;
+   size -= nbOfChunks * chunk_bytes;
+
+   if( size != 0 )
+   {
+      std::memcpy( buffer_.data(), input, size );
+      bufferLen_ = size;
+   }
+
+   return *this;
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+ALWAYS_INLINE Hasher<Algo>& Hasher<Algo>::update( std::string_view data )
+{
+   return update( data.data(), data.length() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Add count zero bytes to the message.
+ *
+ *  Same as update() with a buffer of zeros, without one : the whole chunks
+ *  go through processZeroBlocks, which skips the message schedule.
+ */
+template< typename Algo >
+inline Hasher<Algo>& Hasher<Algo>::updateZeros( std::uint64_t count )
+{
+   msgLen_ += count;
+
+   if( bufferLen_ != 0 )
+   {
+      std::size_t toFill( static_cast< std::size_t >(
+                             std::min< std::uint64_t >( count, chunk_bytes - bufferLen_ ) ) );
+      std::memset( buffer_.data() + bufferLen_, 0, toFill );
+      bufferLen_ += toFill;
+      count -= toFill;
+
+      if( bufferLen_ != chunk_bytes ) { return *this; }
+
+      processChunk<Algo>( hash_, buffer_.data() );
+      bufferLen_ = 0;
+   }
+
+   processZeroBlocks<Algo>( hash_.state, count / chunk_bytes );
+
+   bufferLen_ = static_cast< std::size_t >( count % chunk_bytes );
+   std::memset( buffer_.data(), 0, bufferLen_ );
+
+   return *this;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Pad the message, process the last chunk(s) and return the digest.
+ *
+ *  When the buffered tail leaves no room for the 1 bit and the length, a
+ *  second chunk made only of padding is processed.  The hasher is reset
+ *  afterwards.
+ */
+template< typename Algo >
+inline std::string Hasher<Algo>::finalize()
+{
+   Digest<Algo> digest;
+   finalize( digest );
+   return digest.hex();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Same as finalize(), with the binary digest written to digest.
+ *
+ *  Does not allocate.
+ */
+template< typename Algo >
+inline void Hasher<Algo>::finalize( Digest<Algo>& digest )
+{
+   LastChunks<Algo> lastChunks;
+   auto nbOfChunks = padLastChunk<Algo>( lastChunks, buffer_.data(),
+                                         bufferLen_, msgLen_ );
+   processBlocks<Algo>( hash_.state, lastChunks.data(), nbOfChunks );
+
+   getDigest<Algo>( hash_, digest );
+   reset();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Copy of the hasher, to continue the message received so far in
+ *         another direction.
+ *
+ *  The state, the buffered tail and the length are all copied : updating
+ *  the fork leaves this hasher as it is.
+ */
+template< typename Algo >
+ALWAYS_INLINE Hasher<Algo> Hasher<Algo>::fork() const
+{
+   return *this;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Digest of the message received so far followed by suffix.
+ *
+ *  The hasher is not modified and the prefix is not hashed again : only the
+ *  buffered tail, the suffix and the padding are processed.
+ */
+template< typename Algo >
+inline std::string Hasher<Algo>::finalizeWith( std::string_view suffix ) const
+{
+   Digest<Algo> digest;
+   finalizeWith( suffix.data(), suffix.size(), digest );
+   return digest.hex();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Same as finalizeWith(), with the binary digest written to digest.
+ *
+ *  Does not allocate.
+ */
+template< typename Algo >
+inline void Hasher<Algo>::finalizeWith( void const* suffix, std::size_t size,
+                                        Digest<Algo>& digest ) const
+{
+   auto input = static_cast< std::uint8_t const* >( suffix );
+   std::uint64_t const msgLen( msgLen_ + size );
+   Hash<Algo> theHash( hash_ );
+
+   // The buffered tail, completed by the start of the suffix
+   std::array< std::uint8_t, chunk_bytes > head;
+   std::size_t headLen( bufferLen_ );
+   if( headLen != 0 )
+   {
+      std::size_t toCopy( std::min( size, chunk_bytes - headLen ) );
+      std::memcpy( head.data(), buffer_.data(), headLen );
+      std::memcpy( head.data() + headLen, input, toCopy );
+      headLen += toCopy;
+      input += toCopy;
+      size -= toCopy;
+
+      if( headLen == chunk_bytes )
+      {
+         processChunk<Algo>( theHash, head.data() );
+         headLen = 0;
+      }
+   }
+
+   // Either the head is not full and the suffix is used up, or the head is
+   // empty and the rest of the suffix is hashed in place
+   std::uint8_t const* tail( head.data() );
+   std::size_t tailLen( headLen );
+   if( headLen == 0 )
+   {
+      std::size_t nbOfChunks( size / chunk_bytes );
+      processBlocks<Algo>( theHash.state, input, nbOfChunks );
+      tail = input + nbOfChunks * chunk_bytes;
+      tailLen = size - nbOfChunks * chunk_bytes;
+   }
+
+   LastChunks<Algo> lastChunks;
+   auto nbOfChunks = padLastChunk<Algo>( lastChunks, tail, tailLen, msgLen );
+   processBlocks<Algo>( theHash.state, lastChunks.data(), nbOfChunks );
+
+   getDigest<Algo>( theHash, digest );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Length, in bytes, of the data received since the last reset.
+ */
+template< typename Algo >
+ALWAYS_INLINE std::uint64_t Hasher<Algo>::length() const
+{
+   return msgLen_;
+}
+
+
+} // namespace hashes
@@ -0,0 +1,67 @@
+#ifndef HDQRT_HASH_HMAC_H_
+#define HDQRT_HASH_HMAC_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <climits> // for CHAR_BIT
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../hashes.h"
+
+namespace hashes
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief HMAC (RFC 2104) of messages under one key.
+ *
+ *  The key blocks K xor ipad and K xor opad are compressed once, when the
+ *  key is set, and only their two resulting states are kept.  A message then
+ *  costs its own chunks plus the single chunk of the outer hash, whatever
+ *  the key length.
+ *
+ *  mac() and macBatch() are const and can be called from several threads at
+ *  once.  update() / finalize() stream one message at a time through the
+ *  object.
+ */
+template< typename Algo >
+class Hmac
+{
+public:
+   typedef typename Hash<Algo>::hash_type hash_type;
+
+   static constexpr std::size_t chunk_bytes = Algo::chunk_size / CHAR_BIT;
+
+   explicit Hmac( std::string_view key );
+   Hmac( void const* key, std::size_t keyLen );
+
+   void setKey( void const* key, std::size_t keyLen );
+
+   void mac( void const* msg, std::size_t len, Digest<Algo>& digest ) const;
+   std::string mac( std::string_view msg ) const;
+
+   std::vector< Digest<Algo> > macBatch( std::vector< std::string_view > const& msgs ) const;
+
+   void reset();
+   Hmac& update( void const* data, std::size_t size );
+   Hmac& update( std::string_view data );
+   void finalize( Digest<Algo>& digest );
+   std::string finalize();
+
+   hash_type const& innerState() const;
+   hash_type const& outerState() const;
+
+private:
+   hash_type inner_;
+   hash_type outer_;
+   Hasher<Algo> stream_;
+};
+
+
+} // namespace hashes
+
+#include "Hmac.inl"
+
+#endif // HDQRT_HASH_HMAC_H_
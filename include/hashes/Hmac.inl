@@ -0,0 +1,254 @@
+#include <cstring> // for std::memcpy and std::memset
+#include <algorithm>
+
+#include "../always_inline.h"
+
+namespace hashes
+{
+
+template< typename Algo >
+constexpr std::size_t Hmac<Algo>::chunk_bytes;
+
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Finish a message from a midstate reached after prefixLen bytes.
+ *
+ *  The whole chunks of msg go straight to the kernel, only the tail is
+ *  copied to be padded.  The length encoded counts the prefix.
+ */
+template< typename Algo >
+inline void
+hashFrom( typename Hash<Algo>::hash_type const& midstate, std::uint64_t prefixLen,
+          std::uint8_t const* msg, std::size_t len, Digest<Algo>& digest )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+
+   Hash<Algo> theHash{ midstate };
+   std::size_t const nbOfChunks( len / chunkBytes );
+   hashes::processBlocks<Algo>( theHash.state, msg, nbOfChunks );
+
+   LastChunks<Algo> lastChunks;
+   std::size_t const nbOfLast( padLastChunk<Algo>( lastChunks, msg + nbOfChunks * chunkBytes,
+                                                   len % chunkBytes, prefixLen + len ) );
+   hashes::processBlocks<Algo>( theHash.state, lastChunks.data(), nbOfLast );
+
+   getDigest<Algo>( theHash, digest );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Outer hash of HMAC : the inner digest after the K xor opad chunk.
+ *
+ *  The digest, the padding and the length always fit in one chunk.
+ */
+template< typename Algo >
+ALWAYS_INLINE void
+hmacOuter( typename Hash<Algo>::hash_type const& outer, Digest<Algo> const& inner,
+           Digest<Algo>& digest )
+{
+   constexpr std::size_t chunkBytes( Algo::chunk_size / CHAR_BIT );
+   static_assert( Digest<Algo>::size + 1 + Algo::len_encode_len / CHAR_BIT <= chunkBytes,
+                  "The outer message of HMAC must fit in one chunk." );
+
+   hashFrom<Algo>( outer, chunkBytes, inner.bytes.data(), inner.bytes.size(), digest );
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline Hmac<Algo>::Hmac( std::string_view key )
+   : Hmac( key.data(), key.size() )
+{}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline Hmac<Algo>::Hmac( void const* key, std::size_t keyLen )
+{
+   setKey( key, keyLen );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Compress the two key chunks and keep their states.
+ *
+ *  A key longer than a chunk is hashed first, as RFC 2104 requires.  Any
+ *  message being streamed is dropped.
+ */
+template< typename Algo >
+inline void Hmac<Algo>::setKey( void const* key, std::size_t keyLen )
+{
+   std::array< std::uint8_t, chunk_bytes > block{};
+   if( keyLen > chunk_bytes )
+   {
+      Digest<Algo> hashedKey;
+      details::hashFrom<Algo>( Algo::initHashVals, 0,
+                               static_cast< std::uint8_t const* >( key ), keyLen, hashedKey );
+      std::memcpy( block.data(), hashedKey.bytes.data(), hashedKey.size );
+   }
+   else if( keyLen != 0 )
+   {
+      std::memcpy( block.data(), key, keyLen );
+   }
+
+   for( std::uint8_t& byte : block ) { byte ^= 0x36; }
+   inner_ = Algo::initHashVals;
+   processBlocks<Algo>( inner_, block.data(), 1 );
+
+   // 0x36 ^ 0x5c : from ipad to opad
+   for( std::uint8_t& byte : block ) { byte ^= 0x6a; }
+   outer_ = Algo::initHashVals;
+   processBlocks<Algo>( outer_, block.data(), 1 );
+
+   std::memset( block.data(), 0, block.size() );
+   reset();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief HMAC of one message.
+ *
+ *  Does not allocate.
+ */
+template< typename Algo >
+inline void Hmac<Algo>::mac( void const* msg, std::size_t len, Digest<Algo>& digest ) const
+{
+   Digest<Algo> inner;
+   details::hashFrom<Algo>( inner_, chunk_bytes, static_cast< std::uint8_t const* >( msg ),
+                            len, inner );
+   details::hmacOuter<Algo>( outer_, inner, digest );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Hex HMAC of one message.
+ */
+template< typename Algo >
+inline std::string Hmac<Algo>::mac( std::string_view msg ) const
+{
+   Digest<Algo> digest;
+   mac( msg.data(), msg.size(), digest );
+   return digest.hex();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief HMAC of many messages under the key, in the same order.
+ */
+template< typename Algo >
+inline std::vector< Digest<Algo> >
+Hmac<Algo>::macBatch( std::vector< std::string_view > const& msgs ) const
+{
+   std::vector< Digest<Algo> > digests( msgs.size() );
+   for( std::size_t idx( 0 ); idx != msgs.size(); ++idx )
+   {
+      mac( msgs[idx].data(), msgs[idx].size(), digests[idx] );
+   }
+   return digests;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Drop the message being streamed and start a new one.
+ */
+template< typename Algo >
+inline void Hmac<Algo>::reset()
+{
+   stream_.reset( inner_, chunk_bytes );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Add data to the message being streamed.
+ */
+template< typename Algo >
+inline Hmac<Algo>& Hmac<Algo>::update( void const* data, std::size_t size )
+{
+   stream_.update( data, size );
+   return *this;
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+ALWAYS_INLINE Hmac<Algo>& Hmac<Algo>::update( std::string_view data )
+{
+   return update( data.data(), data.length() );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief HMAC of the message streamed since the last reset.  Starts the
+ *         next message.
+ */
+template< typename Algo >
+inline void Hmac<Algo>::finalize( Digest<Algo>& digest )
+{
+   Digest<Algo> inner;
+   stream_.finalize( inner );
+   details::hmacOuter<Algo>( outer_, inner, digest );
+   reset();
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline std::string Hmac<Algo>::finalize()
+{
+   Digest<Algo> digest;
+   finalize( digest );
+   return digest.hex();
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief State after the K xor ipad chunk : the start of every inner hash.
+ */
+template< typename Algo >
+ALWAYS_INLINE typename Hmac<Algo>::hash_type const& Hmac<Algo>::innerState() const
+{
+   return inner_;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief State after the K xor opad chunk : the start of every outer hash.
+ */
+template< typename Algo >
+ALWAYS_INLINE typename Hmac<Algo>::hash_type const& Hmac<Algo>::outerState() const
+{
+   return outer_;
+}
+
+
+} // namespace hashes
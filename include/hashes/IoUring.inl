@@ -0,0 +1,212 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <cstring> // for std::memset
+#include <cerrno>
+#include <algorithm>
+#include <initializer_list>
+#include <system_error>
+#include <vector>
+
+#if HDQRT_IO_URING
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Minimal io_uring instance, driven through the raw system calls.
+ *
+ *  Pushing submission entries is not thread safe : callers serialize nextSqe
+ *  and submit.  Completions are reaped by a single thread.  Without
+ *  IORING_SETUP_SQPOLL, the kernel only takes entries during submit : those
+ *  it refused when submit throws are dropped, so inFlight counts exactly the
+ *  operations that will still complete.
+ */
+class IoUring
+{
+public:
+   explicit IoUring( unsigned entries )
+      : fd_( -1 ), sqRing_( MAP_FAILED ), cqRing_( MAP_FAILED ), sqes_( nullptr ),
+        sqRingSize_( 0 ), cqRingSize_( 0 ), sqesSize_( 0 ), pending_( 0 ), inFlight_( 0 )
+   {
+      io_uring_params params;
+      std::memset( &params, 0, sizeof( params ) );
+      fd_ = static_cast< int >( ::syscall( __NR_io_uring_setup, entries, &params ) );
+      if( fd_ < 0 ) { return; }
+
+      sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+      cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+      bool const singleMap( params.features & IORING_FEAT_SINGLE_MMAP );
+      if( singleMap ) { sqRingSize_ = cqRingSize_ = std::max( sqRingSize_, cqRingSize_ ); }
+
+      sqRing_ = ::mmap( nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING );
+      if( sqRing_ == MAP_FAILED ) { return; }
+      cqRing_ = singleMap ? sqRing_
+                          : ::mmap( nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING );
+      if( cqRing_ == MAP_FAILED ) { return; }
+
+      sqesSize_ = params.sq_entries * sizeof( io_uring_sqe );
+      void* sqes( ::mmap( nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES ) );
+      if( sqes == MAP_FAILED ) { return; }
+      sqes_ = static_cast< io_uring_sqe* >( sqes );
+
+      auto sq( static_cast< char* >( sqRing_ ) );
+      sqHead_ = reinterpret_cast< unsigned* >( sq + params.sq_off.head );
+      sqTail_ = reinterpret_cast< unsigned* >( sq + params.sq_off.tail );
+      sqMask_ = *reinterpret_cast< unsigned* >( sq + params.sq_off.ring_mask );
+      sqArray_ = reinterpret_cast< unsigned* >( sq + params.sq_off.array );
+      sqEntries_ = params.sq_entries;
+
+      auto cq( static_cast< char* >( cqRing_ ) );
+      cqHead_ = reinterpret_cast< unsigned* >( cq + params.cq_off.head );
+      cqTail_ = reinterpret_cast< unsigned* >( cq + params.cq_off.tail );
+      cqMask_ = *reinterpret_cast< unsigned* >( cq + params.cq_off.ring_mask );
+      cqes_ = reinterpret_cast< io_uring_cqe* >( cq + params.cq_off.cqes );
+   }
+
+   ~IoUring()
+   {
+      if( sqes_ != nullptr ) { ::munmap( sqes_, sqesSize_ ); }
+      if( cqRing_ != MAP_FAILED && cqRing_ != sqRing_ ) { ::munmap( cqRing_, cqRingSize_ ); }
+      if( sqRing_ != MAP_FAILED ) { ::munmap( sqRing_, sqRingSize_ ); }
+      if( fd_ >= 0 ) { ::close( fd_ ); }
+   }
+
+   IoUring( IoUring const& ) = delete;
+   IoUring& operator = ( IoUring const& ) = delete;
+
+   bool valid() const { return sqes_ != nullptr; }
+
+   unsigned entries() const { return sqEntries_; }
+
+   //! Operations taken by the kernel and not reaped yet.
+   std::size_t inFlight() const { return inFlight_; }
+
+   //! Whether the kernel implements every one of the given operations.
+   bool supports( std::initializer_list< int > ops ) const
+   {
+      constexpr unsigned nbOfOps( 256 );
+      std::vector< char > storage( sizeof( io_uring_probe ) + nbOfOps * sizeof( io_uring_probe_op ) );
+      auto probe( reinterpret_cast< io_uring_probe* >( storage.data() ) );
+      if( ::syscall( __NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, nbOfOps ) < 0 )
+      {
+         return false;
+      }
+      for( int op : ops )
+      {
+         if( op > probe->last_op || !( probe->ops[op].flags & IO_URING_OP_SUPPORTED ) )
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   //! Cleared entry to fill, published by the next submit.
+   io_uring_sqe* nextSqe()
+   {
+      unsigned const tail( *sqTail_ + pending_ );
+      io_uring_sqe* sqe( &sqes_[tail & sqMask_] );
+      std::memset( sqe, 0, sizeof( *sqe ) );
+      sqArray_[tail & sqMask_] = tail & sqMask_;
+      ++pending_;
+      return sqe;
+   }
+
+   //! Hand the pending entries to the kernel and wait for waitNr completions.
+   //! On failure, the entries the kernel did not take are dropped.
+   void submit( unsigned waitNr )
+   {
+      __atomic_store_n( sqTail_, *sqTail_ + pending_, __ATOMIC_RELEASE );
+      unsigned toSubmit( pending_ );
+      pending_ = 0;
+
+      for( ;; )
+      {
+         long const res( ::syscall( __NR_io_uring_enter, fd_, toSubmit, waitNr,
+                                    waitNr != 0 ? IORING_ENTER_GETEVENTS : 0u,
+                                    nullptr, 0 ) );
+         if( res >= 0 )
+         {
+            inFlight_ += static_cast< std::size_t >( res );
+            toSubmit -= static_cast< unsigned >( res );
+            if( toSubmit == 0 ) { return; }
+            continue;
+         }
+         if( errno != EINTR && errno != EAGAIN && errno != EBUSY )
+         {
+            int const error( errno );
+            __atomic_store_n( sqTail_, __atomic_load_n( sqHead_, __ATOMIC_ACQUIRE ),
+                              __ATOMIC_RELEASE );
+            throw std::system_error( error, std::generic_category(),
+                                     "io_uring_enter failed" );
+         }
+      }
+   }
+
+   //! Wait for waitNr completions, leaving the pending entries alone.
+   void wait( unsigned waitNr )
+   {
+      while( ::syscall( __NR_io_uring_enter, fd_, 0u, waitNr, IORING_ENTER_GETEVENTS,
+                        nullptr, 0 ) < 0 )
+      {
+         if( errno != EINTR && errno != EAGAIN && errno != EBUSY )
+         {
+            throw std::system_error( errno, std::generic_category(),
+                                     "io_uring_enter failed" );
+         }
+      }
+   }
+
+   //! Call handle( user_data, res ) for every available completion.
+   template< typename Handler >
+   void reap( Handler const& handle )
+   {
+      unsigned head( *cqHead_ );
+      unsigned const tail( __atomic_load_n( cqTail_, __ATOMIC_ACQUIRE ) );
+      for( ; head != tail; ++head )
+      {
+         io_uring_cqe const& cqe( cqes_[head & cqMask_] );
+         --inFlight_;
+         handle( cqe.user_data, cqe.res );
+      }
+      __atomic_store_n( cqHead_, head, __ATOMIC_RELEASE );
+   }
+
+private:
+   int fd_;
+   void* sqRing_;
+   void* cqRing_;
+   io_uring_sqe* sqes_;
+   std::size_t sqRingSize_, cqRingSize_, sqesSize_;
+
+   unsigned* sqHead_;
+   unsigned* sqTail_;
+   unsigned sqMask_;
+   unsigned* sqArray_;
+   unsigned sqEntries_;
+   unsigned pending_;
+   std::size_t inFlight_;
+
+   unsigned* cqHead_;
+   unsigned* cqTail_;
+   unsigned cqMask_;
+   io_uring_cqe* cqes_;
+};
+
+} // namespace details
+
+} // namespace hashes
+
+#endif // HDQRT_IO_URING
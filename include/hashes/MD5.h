@@ -4,16 +4,26 @@
 #include <cstdint>
 #include <array>
 
+#include "../bits.h"
 #include "HashBase.h"
 
 namespace hashes
 {
 
+//------------------------------------------------------------------------------
+/*!
+ *  @brief MD5 (RFC 1321).
+ *
+ *  Broken as a cryptographic hash.  Only for checksums and legacy keys (S3
+ *  ETags, deduplication) where speed is what matters.  Unlike the SHA
+ *  family, message words, length and digest are LITTLE_ENDIAN.
+ */
 struct MD5 : public HashBase
 {
    typedef MD5 family;
    typedef std::uint32_t word_t;
    static constexpr std::uint_fast16_t nb_of_work_vars = 4;
+   static constexpr bits::Endianness byte_order = bits::Endianness::LITTLE;
 
    static constexpr std::uint_fast16_t rounds = 64;
    static constexpr std::uint_fast32_t chunk_size = 512;
@@ -40,8 +50,18 @@ struct MD5 : public HashBase
                    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
                    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 } };
 
+   // Left rotation of each step, four per round
+   static constexpr std::array< std::uint_fast8_t, 16 > shifts = { {
+                   7, 12, 17, 22,
+                   5,  9, 14, 20,
+                   4, 11, 16, 23,
+                   6, 10, 15, 21 } };
+
    static constexpr std::uint_fast16_t digest_len = 128;
 };
+constexpr std::array< typename MD5::word_t, 4 > MD5::initHashVals;
+constexpr std::array< typename MD5::word_t, 64 > MD5::K;
+constexpr std::array< std::uint_fast8_t, 16 > MD5::shifts;
 
 
 } // namespace hashes
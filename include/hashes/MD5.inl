@@ -0,0 +1,130 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <climits> // for CHAR_BIT
+#include <array>
+#include <utility> // for std::index_sequence
+
+#include "../always_inline.h"
+#include "../bits.h"
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Mixing function of an MD5 round : F, G, H then I.
+ *
+ *  F and G are written as selections, one operation shorter than the
+ *  definitions of RFC 1321.
+ */
+template< std::size_t round >
+ALWAYS_INLINE constexpr std::uint32_t
+md5Mix( std::uint32_t b, std::uint32_t c, std::uint32_t d )
+{
+   static_assert( round < 4, "MD5 has four rounds." );
+
+   if constexpr( round == 0 )      { return d ^ ( b & ( c ^ d ) ); }
+   else if constexpr( round == 1 ) { return c ^ ( d & ( b ^ c ) ); }
+   else if constexpr( round == 2 ) { return b ^ c ^ d; }
+   else                            { return c ^ ( b | ~d ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Message word used by step idx.
+ */
+constexpr std::size_t
+md5MessageIndex( std::size_t idx )
+{
+   switch( idx / 16 )
+   {
+      case 0:  return idx % 16;
+      case 1:  return ( 5 * idx + 1 ) % 16;
+      case 2:  return ( 3 * idx + 5 ) % 16;
+      default: return ( 7 * idx ) % 16;
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One MD5 step with the roles of the variables renamed.
+ *
+ *  At step idx, variable a is vars[-idx mod 4], b is the next one and so on.
+ *  Only a is written, and it is where the next step looks for b.  After the
+ *  64 steps, every variable is back in its original place.  The message word
+ *  is read straight from the chunk.
+ */
+template< std::size_t idx >
+ALWAYS_INLINE void
+md5Step( std::array< std::uint32_t, 4 >& vars, std::uint8_t const* chunk )
+{
+   constexpr std::size_t shift( ( 4 - idx % 4 ) % 4 );
+   constexpr std::size_t round( idx / 16 );
+   constexpr std::uint32_t k( MD5::K[idx] );
+   constexpr std::uint_fast16_t moves( MD5::shifts[round * 4 + idx % 4] );
+   constexpr std::size_t word( md5MessageIndex( idx ) );
+
+   std::uint32_t&       a( vars[( shift + 0 ) % 4] );
+   std::uint32_t const& b( vars[( shift + 1 ) % 4] );
+   std::uint32_t const& c( vars[( shift + 2 ) % 4] );
+   std::uint32_t const& d( vars[( shift + 3 ) % 4] );
+
+   a = b + bits::bit_rotate_lt( a + md5Mix< round >( b, c, d ) + k +
+                                   bits::load_le< std::uint32_t >( chunk + 4 * word ),
+                                moves );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< std::size_t... idx >
+ALWAYS_INLINE void
+md5Steps( std::array< std::uint32_t, 4 >& vars, std::uint8_t const* chunk,
+          std::index_sequence< idx... > )
+{
+   ( md5Step< idx >( vars, chunk ), ... );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief MD5 compression of a run of chunks.
+ *
+ *  The 64 steps are unrolled at compile time, so the constants, shifts and
+ *  message offsets are immediates.  There is no message schedule : each step
+ *  reads one of the 16 words of the chunk.
+ */
+ALWAYS_INLINE void
+md5Blocks( std::array< std::uint32_t, 4 >& state, std::uint8_t const* blocks,
+           std::size_t nbOfBlocks )
+{
+   constexpr std::size_t chunkBytes( MD5::chunk_size / CHAR_BIT );
+
+   std::array< std::uint32_t, 4 > vars( state );
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += chunkBytes )
+   {
+      std::array< std::uint32_t, 4 > const saved( vars );
+
+      md5Steps( vars, blocks, std::make_index_sequence< MD5::rounds >() );
+
+      for( std::size_t idx( 0 ); idx != vars.size(); ++idx )
+      {
+         vars[idx] += saved[idx];
+      }
+   }
+
+   state = vars;
+}
+
+} // namespace details
+
+} // namespace hashes
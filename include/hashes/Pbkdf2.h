@@ -0,0 +1,29 @@
+#ifndef HDQRT_HASH_PBKDF2_H_
+#define HDQRT_HASH_PBKDF2_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <string_view>
+#include <vector>
+
+#include "Hmac.h"
+
+namespace hashes
+{
+
+template< typename Algo >
+void pbkdf2( void const* password, std::size_t passwordLen,
+             void const* salt, std::size_t saltLen, std::uint32_t iterations,
+             std::uint8_t* key, std::size_t keyLen, unsigned threads = 0 );
+
+template< typename Algo >
+std::vector< std::uint8_t >
+pbkdf2( std::string_view password, std::string_view salt, std::uint32_t iterations,
+        std::size_t keyLen, unsigned threads = 0 );
+
+
+} // namespace hashes
+
+#include "Pbkdf2.inl"
+
+#endif // HDQRT_HASH_PBKDF2_H_
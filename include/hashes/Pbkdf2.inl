@@ -0,0 +1,139 @@
+#include <cstring> // for std::memcpy
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One output block of PBKDF2 : T_i, the xor of U_1 to U_c.
+ *
+ *  After U_1, every message is a previous U, of the digest length.  Each
+ *  inner and outer hash is then a single chunk made of that U and of a
+ *  padding which never changes : the padding is built once and only the U
+ *  is written over it, both hashes restarting from the states of the key.
+ */
+template< typename Algo >
+inline void
+pbkdf2Block( Hmac<Algo> const& hmac, std::uint8_t const* salt, std::size_t saltLen,
+             std::uint32_t iterations, std::uint32_t blockIdx, Digest<Algo>& block )
+{
+   constexpr std::size_t chunkBytes( Hmac<Algo>::chunk_bytes );
+   constexpr std::size_t digestBytes( Digest<Algo>::size );
+
+   // U_1 = HMAC( P, S || INT( i ) )
+   std::uint8_t const index[4] = { static_cast< std::uint8_t >( blockIdx >> 24 ),
+                                   static_cast< std::uint8_t >( blockIdx >> 16 ),
+                                   static_cast< std::uint8_t >( blockIdx >> 8 ),
+                                   static_cast< std::uint8_t >( blockIdx ) };
+   Hasher<Algo> first;
+   first.reset( hmac.innerState(), chunkBytes );
+   first.update( salt, saltLen );
+   first.update( index, sizeof( index ) );
+   Digest<Algo> inner, u;
+   first.finalize( inner );
+   hmacOuter<Algo>( hmac.outerState(), inner, u );
+   block = u;
+
+   LastChunks<Algo> chunk;
+   padLastChunk<Algo>( chunk, u.bytes.data(), digestBytes, chunkBytes + digestBytes );
+
+   Hash<Algo> theHash;
+   for( std::uint32_t iter( 1 ); iter < iterations; ++iter )
+   {
+      theHash.state = hmac.innerState();
+      hashes::processBlocks<Algo>( theHash.state, chunk.data(), 1 );
+      getDigest<Algo>( theHash, u );
+      std::memcpy( chunk.data(), u.bytes.data(), digestBytes );
+
+      theHash.state = hmac.outerState();
+      hashes::processBlocks<Algo>( theHash.state, chunk.data(), 1 );
+      getDigest<Algo>( theHash, u );
+      std::memcpy( chunk.data(), u.bytes.data(), digestBytes );
+
+      for( std::size_t idx( 0 ); idx != digestBytes; ++idx ) { block.bytes[idx] ^= u.bytes[idx]; }
+   }
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief PBKDF2 (RFC 8018) with HMAC-Algo as the pseudorandom function.
+ *
+ *  The pads of the password are compressed once for all the iterations.
+ *  The output blocks are independent : when keyLen spans several digests,
+ *  they are computed by up to threads threads, one per block.  With 0, the
+ *  hardware concurrency is used.  A key of a single digest is computed by
+ *  the calling thread.
+ *
+ *  Throws std::invalid_argument when iterations is 0 or keyLen is more
+ *  than 2^32 - 1 digests.
+ */
+template< typename Algo >
+inline void
+pbkdf2( void const* password, std::size_t passwordLen,
+        void const* salt, std::size_t saltLen, std::uint32_t iterations,
+        std::uint8_t* key, std::size_t keyLen, unsigned threads )
+{
+   constexpr std::size_t digestBytes( Digest<Algo>::size );
+
+   if( iterations == 0 )
+   {
+      throw std::invalid_argument( "pbkdf2 : the iteration count must be positive" );
+   }
+   std::size_t const nbOfBlocks( ( keyLen + digestBytes - 1 ) / digestBytes );
+   if( nbOfBlocks > std::numeric_limits< std::uint32_t >::max() )
+   {
+      throw std::invalid_argument( "pbkdf2 : derived key too long" );
+   }
+
+   Hmac<Algo> const hmac( password, passwordLen );
+   std::atomic< std::size_t > nextBlock( 0 );
+
+   auto run = [&]()
+   {
+      Digest<Algo> block;
+      for( std::size_t idx( nextBlock++ ); idx < nbOfBlocks; idx = nextBlock++ )
+      {
+         details::pbkdf2Block<Algo>( hmac, static_cast< std::uint8_t const* >( salt ), saltLen,
+                                     iterations, static_cast< std::uint32_t >( idx + 1 ), block );
+         std::size_t const offset( idx * digestBytes );
+         std::memcpy( key + offset, block.bytes.data(),
+                      std::min( digestBytes, keyLen - offset ) );
+      }
+   };
+
+   if( threads == 0 ) { threads = std::max( 1u, std::thread::hardware_concurrency() ); }
+   std::size_t const nbOfThreads( std::min< std::size_t >( threads, nbOfBlocks ) );
+
+   std::vector< std::thread > helpers;
+   for( std::size_t idx( 1 ); idx < nbOfThreads; ++idx ) { helpers.emplace_back( run ); }
+   run();
+   for( std::thread& helper : helpers ) { helper.join(); }
+}
+
+
+
+//------------------------------------------------------------------------------
+template< typename Algo >
+inline std::vector< std::uint8_t >
+pbkdf2( std::string_view password, std::string_view salt, std::uint32_t iterations,
+        std::size_t keyLen, unsigned threads )
+{
+   std::vector< std::uint8_t > key( keyLen );
+   pbkdf2<Algo>( password.data(), password.size(), salt.data(), salt.size(), iterations,
+                 key.data(), keyLen, threads );
+   return key;
+}
+
+} // namespace hashes
@@ -10,6 +10,12 @@ namespace hashes
 {
 
 //------------------------------------------------------------------------------
+/*!
+ *  @brief SHA1 (FIPS 180-4).
+ *
+ *  Broken as a cryptographic hash.  Kept for the formats built on it : git
+ *  object ids, BitTorrent v1 piece hashes.
+ */
 struct SHA1 : public HashBase
 {
    typedef SHA1 family;
@@ -29,8 +35,12 @@ struct SHA1 : public HashBase
 
    static constexpr std::uint_fast16_t digest_len = 160;
 };
+constexpr std::array< typename SHA1::word_t, 5 > SHA1::initHashVals;
+constexpr std::array< typename SHA1::word_t, 4 > SHA1::K;
 
 
 } // namespace hashes
 
+#include "SHA1.inl"
+
 #endif // HDQRT_HASH_SHA1_H_
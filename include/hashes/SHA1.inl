@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <climits> // for CHAR_BIT
+#include <array>
+#include <utility> // for std::index_sequence
+
+#include "../always_inline.h"
+#include "../bits.h"
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Function of SHA1 steps 20 * part to 20 * part + 19 : Ch, Parity,
+ *         Maj then Parity again.
+ */
+template< std::size_t part >
+ALWAYS_INLINE constexpr std::uint32_t
+sha1Mix( std::uint32_t b, std::uint32_t c, std::uint32_t d )
+{
+   static_assert( part < 4, "SHA1 has four parts of 20 steps." );
+
+   if constexpr( part == 0 )      { return d ^ ( b & ( c ^ d ) ); }
+   else if constexpr( part == 2 ) { return ( b & c ) | ( d & ( b | c ) ); }
+   else                           { return b ^ c ^ d; }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One SHA1 step with the roles of the variables renamed.
+ *
+ *  At step idx, variable a is vars[-idx mod 5], b is the next one and so on.
+ *  Only b and e are written : b is rotated in place and becomes the next c,
+ *  e becomes the next a.  After the 80 steps, every variable is back in its
+ *  original place.
+ *
+ *  The schedule is a 16 word window : W[idx] overwrites W[idx - 16].
+ */
+template< std::size_t idx >
+ALWAYS_INLINE void
+sha1Step( std::array< std::uint32_t, 5 >& vars, std::array< std::uint32_t, 16 >& W )
+{
+   constexpr std::size_t shift( ( 5 - idx % 5 ) % 5 );
+   constexpr std::uint32_t k( SHA1::K[idx / 20] );
+
+   std::uint32_t const& a( vars[( shift + 0 ) % 5] );
+   std::uint32_t&       b( vars[( shift + 1 ) % 5] );
+   std::uint32_t const& c( vars[( shift + 2 ) % 5] );
+   std::uint32_t const& d( vars[( shift + 3 ) % 5] );
+   std::uint32_t&       e( vars[( shift + 4 ) % 5] );
+
+   if constexpr( idx >= 16 )
+   {
+      W[idx & 15] = bits::bit_rotate_lt( W[( idx - 3 ) & 15] ^ W[( idx - 8 ) & 15] ^
+                                         W[( idx - 14 ) & 15] ^ W[idx & 15], 1 );
+   }
+
+   e += bits::bit_rotate_lt( a, 5 ) + sha1Mix< idx / 20 >( b, c, d ) + k + W[idx & 15];
+   b = bits::bit_rotate_lt( b, 30 );
+}
+
+
+
+//------------------------------------------------------------------------------
+template< std::size_t... idx >
+ALWAYS_INLINE void
+sha1Steps( std::array< std::uint32_t, 5 >& vars, std::array< std::uint32_t, 16 >& W,
+           std::index_sequence< idx... > )
+{
+   ( sha1Step< idx >( vars, W ), ... );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA1 compression of a run of chunks.
+ *
+ *  The 80 steps are unrolled at compile time and the message schedule is
+ *  computed just in time in a 16 word window (64 bytes instead of 320).
+ */
+ALWAYS_INLINE void
+sha1Blocks( std::array< std::uint32_t, 5 >& state, std::uint8_t const* blocks,
+            std::size_t nbOfBlocks )
+{
+   constexpr std::size_t chunkBytes( SHA1::chunk_size / CHAR_BIT );
+
+   std::array< std::uint32_t, 5 > vars( state );
+   std::array< std::uint32_t, 16 > W;
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += chunkBytes )
+   {
+      std::array< std::uint32_t, 5 > const saved( vars );
+
+      bits::load_be( W.data(), blocks, 16 );
+      sha1Steps( vars, W, std::make_index_sequence< SHA1::rounds >() );
+
+      for( std::size_t idx( 0 ); idx != vars.size(); ++idx )
+      {
+         vars[idx] += saved[idx];
+      }
+   }
+
+   state = vars;
+}
+
+} // namespace details
+
+} // namespace hashes
+
+#include "SHA1_shani.inl"
@@ -0,0 +1,117 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <utility> // for std::index_sequence
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+#if HDQRT_X86_BACKENDS
+#  include <immintrin.h>
+
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Four SHA1 rounds with the Intel SHA extensions.
+ *
+ *  msg holds the schedule words of the last four groups, group % 4 being the
+ *  current one.  e holds ABCD as it was before the previous group : sha1nexte
+ *  derives E from it and adds it to the message words.  While the rounds run,
+ *  sha1msg2 finishes the words of the next group, sha1msg1 and a xor start
+ *  the ones of the two groups after it.
+ */
+template< std::size_t group >
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+sha1GroupShaNi( __m128i& abcd, __m128i& e, __m128i (&msg)[4] )
+{
+   __m128i const& w( msg[group % 4] );
+
+   __m128i ew;
+   if constexpr( group == 0 ) { ew = _mm_add_epi32( e, w ); }
+   else                       { ew = _mm_sha1nexte_epu32( e, w ); }
+   e = abcd;
+
+   if constexpr( group >= 3 && group <= 18 )
+   {
+      msg[( group + 1 ) % 4] = _mm_sha1msg2_epu32( msg[( group + 1 ) % 4], w );
+   }
+   abcd = _mm_sha1rnds4_epu32( abcd, ew, group / 5 );
+   if constexpr( group >= 1 && group <= 16 )
+   {
+      msg[( group + 3 ) % 4] = _mm_sha1msg1_epu32( msg[( group + 3 ) % 4], w );
+   }
+   if constexpr( group >= 2 && group <= 17 )
+   {
+      msg[( group + 2 ) % 4] = _mm_xor_si128( msg[( group + 2 ) % 4], w );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+template< std::size_t... group >
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+sha1GroupsShaNi( __m128i& abcd, __m128i& e, __m128i (&msg)[4],
+                 std::index_sequence< group... > )
+{
+   ( sha1GroupShaNi< group >( abcd, e, msg ), ... );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA1 compression of a run of chunks with the Intel SHA extensions.
+ *
+ *  Only call when cpu::hasShaNi() is true.  The hardware keeps A in the high
+ *  lane of one register and E in the high lane of another, so the state is
+ *  reversed once before the first chunk and back once after the last one.
+ *  Each sha1rnds4 does four rounds.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" )
+inline void
+sha1BlocksShaNi( std::uint32_t* state, std::uint8_t const* blocks,
+                 std::size_t nbOfBlocks )
+{
+   // Whole 16 bytes reversed : the words end up big endian and in reverse
+   // order, as the hardware wants them
+   __m128i const reverseMask( _mm_set_epi64x( 0x0001020304050607ULL,
+                                              0x08090a0b0c0d0e0fULL ) );
+
+   __m128i abcd( _mm_shuffle_epi32(
+                    _mm_loadu_si128( reinterpret_cast< __m128i const* >( state ) ), 0x1B ) );
+   __m128i e( _mm_set_epi32( static_cast< int >( state[4] ), 0, 0, 0 ) );
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += 64 )
+   {
+      __m128i const abcdSave( abcd );
+      __m128i const eSave( e );
+      __m128i const* input( reinterpret_cast< __m128i const* >( blocks ) );
+
+      __m128i msg[4] = {
+                  _mm_shuffle_epi8( _mm_loadu_si128( input + 0 ), reverseMask ),
+                  _mm_shuffle_epi8( _mm_loadu_si128( input + 1 ), reverseMask ),
+                  _mm_shuffle_epi8( _mm_loadu_si128( input + 2 ), reverseMask ),
+                  _mm_shuffle_epi8( _mm_loadu_si128( input + 3 ), reverseMask ) };
+
+      sha1GroupsShaNi( abcd, e, msg, std::make_index_sequence< 20 >() );
+
+      // e holds ABCD from before the last group : its A rotated is the new E
+      e = _mm_sha1nexte_epu32( e, eSave );
+      abcd = _mm_add_epi32( abcd, abcdSave );
+   }
+
+   _mm_storeu_si128( reinterpret_cast< __m128i* >( state ), _mm_shuffle_epi32( abcd, 0x1B ) );
+   state[4] = static_cast< std::uint32_t >( _mm_extract_epi32( e, 3 ) );
+}
+
+} // namespace details
+
+} // namespace hashes
+
+#endif // HDQRT_X86_BACKENDS
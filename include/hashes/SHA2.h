@@ -17,10 +17,10 @@ struct SHA256;
 struct SHA512;
 
 template< typename IntType >
-IntType Ch( IntType x, IntType y, IntType z );
+constexpr IntType Ch( IntType x, IntType y, IntType z );
 
 template< typename IntType >
-IntType Maj( IntType x, IntType y, IntType z );
+constexpr IntType Maj( IntType x, IntType y, IntType z );
 
 
 //------------------------------------------------------------------------------
@@ -30,20 +30,20 @@ using is_sha2 = std::integral_constant< bool, std::is_base_of< SHA2, Hash >::val
 template< typename Hash >
 using is_sha2_derived = std::integral_constant< bool,
                                                 ( ( is_sha2< Hash >::value ) &&
-                                                  ( std::is_same< SHA2, Hash >::value ) ) >;
+                                                  ( !std::is_same< SHA2, Hash >::value ) ) >;
 
 
 template< typename Algo >
-typename Algo::word_t Sigma0( typename Algo::word_t x );
+constexpr typename Algo::word_t Sigma0( typename Algo::word_t x );
 
 template< typename Algo >
-typename Algo::word_t sigma0( typename Algo::word_t x );
+constexpr typename Algo::word_t sigma0( typename Algo::word_t x );
 
 template< typename Algo >
-typename Algo::word_t Sigma1( typename Algo::word_t x );
+constexpr typename Algo::word_t Sigma1( typename Algo::word_t x );
 
 template< typename Algo >
-typename Algo::word_t Sigma1( typename Algo::word_t x );
+constexpr typename Algo::word_t sigma1( typename Algo::word_t x );
 
 
 }
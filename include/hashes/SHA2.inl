@@ -9,7 +9,7 @@ namespace hashes
  *  @brief Ch function of SHA2 family of hashes.
  */
 template< typename IntType >
-ALWAYS_INLINE IntType Ch( IntType x, IntType y, IntType z )
+ALWAYS_INLINE constexpr IntType Ch( IntType x, IntType y, IntType z )
 {
    static_assert( std::is_integral< IntType >::value,
                   "Ch not defined for non-integral types" );
@@ -23,7 +23,7 @@ ALWAYS_INLINE IntType Ch( IntType x, IntType y, IntType z )
  *  @brief Maj function of SHA2 family of hashes.
  */
 template< typename IntType >
-ALWAYS_INLINE IntType Maj( IntType x, IntType y, IntType z )
+ALWAYS_INLINE constexpr IntType Maj( IntType x, IntType y, IntType z )
 {
    static_assert( std::is_integral< IntType >::value,
                   "Maj not defined for non-integral types" );
@@ -207,7 +207,7 @@ struct sigma_fn_params< SHA512, Min, One >
  *  called.
  */
 template< typename T >
-ALWAYS_INLINE T do_sigma( T x, std::uint_fast8_t val, Cap )
+ALWAYS_INLINE constexpr T do_sigma( T x, std::uint_fast8_t val, Cap )
 { return bits::bit_rotate_rt( x, val ); }
 
 
@@ -221,7 +221,7 @@ ALWAYS_INLINE T do_sigma( T x, std::uint_fast8_t val, Cap )
  *  called.
  */
 template< typename T >
-ALWAYS_INLINE T do_sigma( T x, std::uint_fast8_t val, Min )
+ALWAYS_INLINE constexpr T do_sigma( T x, std::uint_fast8_t val, Min )
 { return x >> val; }
 
 
@@ -231,7 +231,7 @@ ALWAYS_INLINE T do_sigma( T x, std::uint_fast8_t val, Min )
  *  @brief Last step of SHA2 sigma function.
  */
 template< typename Algo, typename MinOrCap >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 inner_sigma( typename Algo::word_t x, std::uint_fast8_t val )
 {
    typedef typename Algo::word_t word_t;
@@ -253,7 +253,7 @@ inner_sigma( typename Algo::word_t x, std::uint_fast8_t val )
  *
  */
 template< typename Algo, typename MinOrCap, typename ZeroOrOne >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 sigma( typename Algo::word_t x )
 {
    // Get appropriate indexes.  Type must match sha_family_traits::*igma* types.
@@ -276,7 +276,7 @@ sigma( typename Algo::word_t x )
  *  @brief Sigma0 (Capital, zero) of SHA2 family of hashes.
  */
 template< typename Algo >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 Sigma0( typename Algo::word_t x )
 {
    return details::sigma<Algo, details::Cap, details::Zero>( x );
@@ -289,7 +289,7 @@ Sigma0( typename Algo::word_t x )
  *  @brief sigma0 (capital, zero) of SHA2 family of hashes.
  */
 template< typename Algo >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 sigma0( typename Algo::word_t x )
 {
    return details::sigma<Algo, details::Min, details::Zero>( x );
@@ -302,7 +302,7 @@ sigma0( typename Algo::word_t x )
  *  @brief Sigma0 (Capital, zero) of SHA2 family of hashes.
  */
 template< typename Algo >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 Sigma1( typename Algo::word_t x )
 {
    return details::sigma<Algo, details::Cap, details::One>( x );
@@ -315,7 +315,7 @@ Sigma1( typename Algo::word_t x )
  *  @brief sigma1 (capital, zero) of SHA2 family of hashes.
  */
 template< typename Algo >
-ALWAYS_INLINE typename Algo::word_t
+ALWAYS_INLINE constexpr typename Algo::word_t
 sigma1( typename Algo::word_t x )
 {
    return details::sigma<Algo, details::Min, details::One>( x );
@@ -21,9 +21,15 @@ struct SHA224 : public SHA256
    static constexpr uint_fast32_t chunk_size = SHA256::chunk_size;
    static constexpr std::uint_fast16_t len_encode_len = 64;
 
+   static constexpr std::array< word_t, 8 > initHashVals = { {
+                 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+                 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4  } };
+
    static constexpr std::uint_fast16_t digest_len = 224;
 };
 
+constexpr std::array< typename SHA224::word_t, 8 > SHA224::initHashVals;
+
 } // namespace hashes
 
 #include "SHA224.inl"
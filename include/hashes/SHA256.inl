@@ -0,0 +1,65 @@
+#include <cstdint>
+#include <array>
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Message schedule of the SHA256 chunk made only of padding, which
+ *         ends a message of msgBits bits filling whole chunks.
+ *
+ *  It does not depend on the message : the kernels of sha256d64 take it as a
+ *  compile-time constant instead of loading and expanding it.
+ */
+constexpr std::array< std::uint32_t, SHA256::rounds >
+sha256PaddingSchedule( std::uint64_t msgBits )
+{
+   std::array< std::uint32_t, SHA256::rounds > W{};
+   W[0] = 0x80000000;
+   W[14] = static_cast< std::uint32_t >( msgBits >> 32 );
+   W[15] = static_cast< std::uint32_t >( msgBits );
+   for( std::size_t idx( 16 ); idx != SHA256::rounds; ++idx )
+   {
+      W[idx] = sigma1<SHA256>( W[idx - 2] ) + W[idx - 7] +
+                                 sigma0<SHA256>( W[idx - 15] ) + W[idx - 16];
+   }
+   return W;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Schedule W with K added, word by word.
+ */
+constexpr std::array< std::uint32_t, SHA256::rounds >
+sha256PlusK( std::array< std::uint32_t, SHA256::rounds > W )
+{
+   for( std::size_t idx( 0 ); idx != SHA256::rounds; ++idx ) { W[idx] += SHA256::K[idx]; }
+   return W;
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Schedule of the padding chunk after a 64 bytes message, and the
+ *         same with K added, for the kernels which add K to the schedule.
+ */
+constexpr std::array< std::uint32_t, SHA256::rounds >
+sha256_padding64_w = sha256PaddingSchedule( 512 );
+
+alignas( 32 ) constexpr std::array< std::uint32_t, SHA256::rounds >
+sha256_padding64_kw = sha256PlusK( sha256_padding64_w );
+
+} // namespace details
+
+} // namespace hashes
+
+#include "SHA256_shani.inl"
+#include "SHA256_ssse3.inl"
+#include "SHA256_avx2.inl"
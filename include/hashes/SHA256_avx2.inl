@@ -0,0 +1,283 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+#if HDQRT_X86_BACKENDS
+#  include <immintrin.h>
+
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rotate right each 32 bits lane.
+ */
+template< int moves >
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE __m256i rotateRightX8( __m256i x )
+{
+   return _mm256_or_si256( _mm256_srli_epi32( x, moves ),
+                           _mm256_slli_epi32( x, 32 - moves ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Transpose 8 rows of 8 words so that row i holds word i of each lane.
+ */
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE void transposeX8( __m256i* rows )
+{
+   __m256i t0( _mm256_unpacklo_epi32( rows[0], rows[1] ) );
+   __m256i t1( _mm256_unpackhi_epi32( rows[0], rows[1] ) );
+   __m256i t2( _mm256_unpacklo_epi32( rows[2], rows[3] ) );
+   __m256i t3( _mm256_unpackhi_epi32( rows[2], rows[3] ) );
+   __m256i t4( _mm256_unpacklo_epi32( rows[4], rows[5] ) );
+   __m256i t5( _mm256_unpackhi_epi32( rows[4], rows[5] ) );
+   __m256i t6( _mm256_unpacklo_epi32( rows[6], rows[7] ) );
+   __m256i t7( _mm256_unpackhi_epi32( rows[6], rows[7] ) );
+
+   __m256i u0( _mm256_unpacklo_epi64( t0, t2 ) );
+   __m256i u1( _mm256_unpackhi_epi64( t0, t2 ) );
+   __m256i u2( _mm256_unpacklo_epi64( t1, t3 ) );
+   __m256i u3( _mm256_unpackhi_epi64( t1, t3 ) );
+   __m256i u4( _mm256_unpacklo_epi64( t4, t6 ) );
+   __m256i u5( _mm256_unpackhi_epi64( t4, t6 ) );
+   __m256i u6( _mm256_unpacklo_epi64( t5, t7 ) );
+   __m256i u7( _mm256_unpackhi_epi64( t5, t7 ) );
+
+   rows[0] = _mm256_permute2x128_si256( u0, u4, 0x20 );
+   rows[1] = _mm256_permute2x128_si256( u1, u5, 0x20 );
+   rows[2] = _mm256_permute2x128_si256( u2, u6, 0x20 );
+   rows[3] = _mm256_permute2x128_si256( u3, u7, 0x20 );
+   rows[4] = _mm256_permute2x128_si256( u0, u4, 0x31 );
+   rows[5] = _mm256_permute2x128_si256( u1, u5, 0x31 );
+   rows[6] = _mm256_permute2x128_si256( u2, u6, 0x31 );
+   rows[7] = _mm256_permute2x128_si256( u3, u7, 0x31 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief One SHA256 round in each of 8 lanes, kw being K plus the word of
+ *         the schedule.
+ */
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE void
+sha256x8Round( __m256i (&v)[8], __m256i kw )
+{
+   __m256i& a( v[0] );
+   __m256i& b( v[1] );
+   __m256i& c( v[2] );
+   __m256i& d( v[3] );
+   __m256i& e( v[4] );
+   __m256i& f( v[5] );
+   __m256i& g( v[6] );
+   __m256i& h( v[7] );
+
+   __m256i S1( _mm256_xor_si256( _mm256_xor_si256( rotateRightX8<6>( e ),
+                                                   rotateRightX8<11>( e ) ),
+                                 rotateRightX8<25>( e ) ) );
+   __m256i ch( _mm256_xor_si256( _mm256_and_si256( e, f ),
+                                 _mm256_andnot_si256( e, g ) ) );
+   __m256i T1( _mm256_add_epi32( _mm256_add_epi32( h, S1 ), _mm256_add_epi32( ch, kw ) ) );
+
+   __m256i S0( _mm256_xor_si256( _mm256_xor_si256( rotateRightX8<2>( a ),
+                                                   rotateRightX8<13>( a ) ),
+                                 rotateRightX8<22>( a ) ) );
+   __m256i maj( _mm256_xor_si256( _mm256_and_si256( a, b ),
+                                  _mm256_and_si256( c, _mm256_xor_si256( a, b ) ) ) );
+   __m256i T2( _mm256_add_epi32( S0, maj ) );
+
+   h = g;
+   g = f;
+   f = e;
+   e = _mm256_add_epi32( d, T1 );
+   d = c;
+   c = b;
+   b = a;
+   a = _mm256_add_epi32( T1, T2 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Compress one chunk in each of 8 lanes.
+ *
+ *  state[w] holds word w of the state of the 8 lanes, W[w] word w of their
+ *  chunks, host order.  W is used as the 16 word rolling schedule.
+ */
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE void
+sha256x8Chunk( __m256i (&state)[8], __m256i (&W)[16] )
+{
+   __m256i v[8];
+   for( int idx( 0 ); idx != 8; ++idx ) { v[idx] = state[idx]; }
+
+   for( int idx( 0 ); idx != 64; ++idx )
+   {
+      // 16 word rolling message schedule
+      __m256i& w( W[idx & 15] );
+      if( idx >= 16 )
+      {
+         __m256i w2( W[( idx - 2 ) & 15] );
+         __m256i w15( W[( idx - 15 ) & 15] );
+         __m256i s0( _mm256_xor_si256( _mm256_xor_si256( rotateRightX8<7>( w15 ),
+                                                         rotateRightX8<18>( w15 ) ),
+                                       _mm256_srli_epi32( w15, 3 ) ) );
+         __m256i s1( _mm256_xor_si256( _mm256_xor_si256( rotateRightX8<17>( w2 ),
+                                                         rotateRightX8<19>( w2 ) ),
+                                       _mm256_srli_epi32( w2, 10 ) ) );
+         w = _mm256_add_epi32( _mm256_add_epi32( w, s0 ),
+                               _mm256_add_epi32( W[( idx - 7 ) & 15], s1 ) );
+      }
+
+      sha256x8Round( v, _mm256_add_epi32(
+                           _mm256_set1_epi32( static_cast< int >( SHA256::K[idx] ) ), w ) );
+   }
+
+   for( int idx( 0 ); idx != 8; ++idx ) { state[idx] = _mm256_add_epi32( state[idx], v[idx] ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Compress, in each of 8 lanes, a chunk whose schedule with K added,
+ *         kw, is known and the same in every lane.
+ */
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE void
+sha256x8KnownChunk( __m256i (&state)[8], std::uint32_t const* kw )
+{
+   __m256i v[8];
+   for( int idx( 0 ); idx != 8; ++idx ) { v[idx] = state[idx]; }
+
+   for( int idx( 0 ); idx != 64; ++idx )
+   {
+      sha256x8Round( v, _mm256_set1_epi32( static_cast< int >( kw[idx] ) ) );
+   }
+
+   for( int idx( 0 ); idx != 8; ++idx ) { state[idx] = _mm256_add_epi32( state[idx], v[idx] ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Load word major the 64 bytes at blocks[lane] of the 8 lanes.
+ */
+HDQRT_TARGET( "avx2" ) ALWAYS_INLINE void
+loadX8( __m256i (&W)[16], std::uint8_t const* const (&blocks)[8] )
+{
+   __m256i const bswapMask( _mm256_set_epi8(
+                  12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3,
+                  12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3 ) );
+
+   for( int half( 0 ); half != 2; ++half )
+   {
+      for( int lane( 0 ); lane != 8; ++lane )
+      {
+         W[half * 8 + lane] = _mm256_loadu_si256(
+               reinterpret_cast< __m256i const* >( blocks[lane] + half * 32 ) );
+      }
+      transposeX8( W + half * 8 );
+   }
+   for( int idx( 0 ); idx != 16; ++idx )
+   {
+      W[idx] = _mm256_shuffle_epi8( W[idx], bswapMask );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256 compression of one chunk in each of 8 independent lanes.
+ *
+ *  Only call when cpu::hasAvx2() is true.  The state is kept as a structure
+ *  of arrays : state[w][lane] is word w of lane's state, so each working
+ *  variable of the 8 lanes sits in one AVX2 register.  The state must be 32
+ *  bytes aligned.  blocks[lane] points to the 64 bytes to compress in that
+ *  lane.
+ */
+HDQRT_TARGET( "avx2" )
+inline void
+sha256x8BlocksAvx2( std::uint32_t (&state)[8][8],
+                    std::uint8_t const* const (&blocks)[8] )
+{
+   __m256i W[16];
+   loadX8( W, blocks );
+
+   __m256i* words( reinterpret_cast< __m256i* >( state ) );
+   __m256i vars[8];
+   for( int idx( 0 ); idx != 8; ++idx ) { vars[idx] = _mm256_load_si256( words + idx ); }
+
+   sha256x8Chunk( vars, W );
+
+   for( int idx( 0 ); idx != 8; ++idx ) { _mm256_store_si256( words + idx, vars[idx] ); }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256( SHA256( x ) ) of 8 contiguous 64 bytes inputs, one per
+ *         lane, written as 8 contiguous 32 bytes digests.
+ *
+ *  Only call when cpu::hasAvx2() is true.  The padding chunk of the inner
+ *  hash has the same precomputed schedule in every lane.  The inner digests
+ *  never leave the registers : word major already, they are the first eight
+ *  schedule words of the outer hash, the last eight being constants.  Only
+ *  the final digests are transposed back, one row per lane.
+ */
+HDQRT_TARGET( "avx2" )
+inline void
+sha256d64x8Avx2( std::uint8_t const* inputs, std::uint8_t* digests )
+{
+   __m256i const bswapMask( _mm256_set_epi8(
+                  12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3,
+                  12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3 ) );
+
+   std::uint8_t const* const blocks[8] = { inputs, inputs + 64, inputs + 128, inputs + 192,
+                                           inputs + 256, inputs + 320, inputs + 384,
+                                           inputs + 448 };
+   __m256i W[16];
+   loadX8( W, blocks );
+
+   __m256i inner[8];
+   for( int idx( 0 ); idx != 8; ++idx )
+   {
+      inner[idx] = _mm256_set1_epi32( static_cast< int >( SHA256::initHashVals[idx] ) );
+   }
+   sha256x8Chunk( inner, W );
+   sha256x8KnownChunk( inner, sha256_padding64_kw.data() );
+
+   __m256i outer[8];
+   for( int idx( 0 ); idx != 8; ++idx )
+   {
+      W[idx] = inner[idx];
+      W[idx + 8] = _mm256_setzero_si256();
+      outer[idx] = _mm256_set1_epi32( static_cast< int >( SHA256::initHashVals[idx] ) );
+   }
+   W[8] = _mm256_set1_epi32( static_cast< int >( 0x80000000 ) );
+   W[15] = _mm256_set1_epi32( 256 );
+   sha256x8Chunk( outer, W );
+
+   transposeX8( outer );
+   for( int lane( 0 ); lane != 8; ++lane )
+   {
+      _mm256_storeu_si256( reinterpret_cast< __m256i* >( digests + lane * 32 ),
+                           _mm256_shuffle_epi8( outer[lane], bswapMask ) );
+   }
+}
+
+} // namespace details
+
+} // namespace hashes
+
+#endif // HDQRT_X86_BACKENDS
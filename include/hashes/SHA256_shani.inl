@@ -0,0 +1,396 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+#if HDQRT_X86_BACKENDS
+#  include <immintrin.h>
+
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Shuffle a state from ABCD / EFGH to the ABEF / CDGH split of the
+ *         SHA extensions.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+toAbefShaNi( __m128i& abcd, __m128i& efgh )
+{
+   __m128i tmp( _mm_shuffle_epi32( abcd, 0xB1 ) );
+   efgh = _mm_shuffle_epi32( efgh, 0x1B );
+   abcd = _mm_alignr_epi8( tmp, efgh, 8 );
+   efgh = _mm_blend_epi16( efgh, tmp, 0xF0 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Shuffle a state from ABEF / CDGH back to ABCD / EFGH.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+fromAbefShaNi( __m128i& abef, __m128i& cdgh )
+{
+   __m128i tmp( _mm_shuffle_epi32( abef, 0x1B ) );
+   cdgh = _mm_shuffle_epi32( cdgh, 0xB1 );
+   abef = _mm_blend_epi16( tmp, cdgh, 0xF0 );
+   cdgh = _mm_alignr_epi8( cdgh, tmp, 8 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Compress one chunk into an ABEF / CDGH state.
+ *
+ *  msg0 to msg3 hold the 16 words of the chunk, already in host order.  Each
+ *  sha256rnds2 does two rounds, the sha256msg1 / sha256msg2 pair computes
+ *  the message schedule four words at a time.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+sha256ChunkShaNi( __m128i& state0, __m128i& state1,
+                  __m128i msg0, __m128i msg1, __m128i msg2, __m128i msg3 )
+{
+   __m128i const* k( reinterpret_cast< __m128i const* >( SHA256::K.data() ) );
+   __m128i const abefSave( state0 );
+   __m128i const cdghSave( state1 );
+   __m128i msg, tmp;
+
+   // Rounds 0-3
+   msg = _mm_add_epi32( msg0, _mm_loadu_si128( k + 0 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+   // Rounds 4-7
+   msg = _mm_add_epi32( msg1, _mm_loadu_si128( k + 1 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+   // Rounds 8-11
+   msg = _mm_add_epi32( msg2, _mm_loadu_si128( k + 2 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+   // Rounds 12-15
+   msg = _mm_add_epi32( msg3, _mm_loadu_si128( k + 3 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+   msg0 = _mm_add_epi32( msg0, tmp );
+   msg0 = _mm_sha256msg2_epu32( msg0, msg3 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+   // Rounds 16-19
+   msg = _mm_add_epi32( msg0, _mm_loadu_si128( k + 4 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+   msg1 = _mm_add_epi32( msg1, tmp );
+   msg1 = _mm_sha256msg2_epu32( msg1, msg0 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+   // Rounds 20-23
+   msg = _mm_add_epi32( msg1, _mm_loadu_si128( k + 5 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+   msg2 = _mm_add_epi32( msg2, tmp );
+   msg2 = _mm_sha256msg2_epu32( msg2, msg1 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+   // Rounds 24-27
+   msg = _mm_add_epi32( msg2, _mm_loadu_si128( k + 6 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+   msg3 = _mm_add_epi32( msg3, tmp );
+   msg3 = _mm_sha256msg2_epu32( msg3, msg2 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+   // Rounds 28-31
+   msg = _mm_add_epi32( msg3, _mm_loadu_si128( k + 7 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+   msg0 = _mm_add_epi32( msg0, tmp );
+   msg0 = _mm_sha256msg2_epu32( msg0, msg3 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+   // Rounds 32-35
+   msg = _mm_add_epi32( msg0, _mm_loadu_si128( k + 8 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+   msg1 = _mm_add_epi32( msg1, tmp );
+   msg1 = _mm_sha256msg2_epu32( msg1, msg0 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+   // Rounds 36-39
+   msg = _mm_add_epi32( msg1, _mm_loadu_si128( k + 9 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+   msg2 = _mm_add_epi32( msg2, tmp );
+   msg2 = _mm_sha256msg2_epu32( msg2, msg1 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+   // Rounds 40-43
+   msg = _mm_add_epi32( msg2, _mm_loadu_si128( k + 10 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+   msg3 = _mm_add_epi32( msg3, tmp );
+   msg3 = _mm_sha256msg2_epu32( msg3, msg2 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+   // Rounds 44-47
+   msg = _mm_add_epi32( msg3, _mm_loadu_si128( k + 11 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+   msg0 = _mm_add_epi32( msg0, tmp );
+   msg0 = _mm_sha256msg2_epu32( msg0, msg3 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+   // Rounds 48-51
+   msg = _mm_add_epi32( msg0, _mm_loadu_si128( k + 12 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+   msg1 = _mm_add_epi32( msg1, tmp );
+   msg1 = _mm_sha256msg2_epu32( msg1, msg0 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+   // Rounds 52-55
+   msg = _mm_add_epi32( msg1, _mm_loadu_si128( k + 13 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+   msg2 = _mm_add_epi32( msg2, tmp );
+   msg2 = _mm_sha256msg2_epu32( msg2, msg1 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+   // Rounds 56-59
+   msg = _mm_add_epi32( msg2, _mm_loadu_si128( k + 14 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+   msg3 = _mm_add_epi32( msg3, tmp );
+   msg3 = _mm_sha256msg2_epu32( msg3, msg2 );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+   // Rounds 60-63
+   msg = _mm_add_epi32( msg3, _mm_loadu_si128( k + 15 ) );
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+   msg = _mm_shuffle_epi32( msg, 0x0E );
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+   state0 = _mm_add_epi32( state0, abefSave );
+   state1 = _mm_add_epi32( state1, cdghSave );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Compress one chunk whose schedule with K added, kw, is known.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+sha256KnownChunkShaNi( __m128i& state0, __m128i& state1, std::uint32_t const* kw )
+{
+   __m128i const abefSave( state0 );
+   __m128i const cdghSave( state1 );
+
+   for( std::size_t group( 0 ); group != 16; ++group )
+   {
+      __m128i msg( _mm_loadu_si128( reinterpret_cast< __m128i const* >( kw ) + group ) );
+      state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+      msg = _mm_shuffle_epi32( msg, 0x0E );
+      state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+   }
+
+   state0 = _mm_add_epi32( state0, abefSave );
+   state1 = _mm_add_epi32( state1, cdghSave );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256 compression of a run of chunks with the Intel SHA extensions.
+ *
+ *  Only call when cpu::hasShaNi() is true.  The hardware works on the state
+ *  split as ABEF / CDGH, so it is shuffled in once before the first chunk and
+ *  back once after the last one.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" )
+inline void
+sha256BlocksShaNi( std::uint32_t* state, std::uint8_t const* blocks,
+                   std::size_t nbOfBlocks )
+{
+   __m128i const bswapMask( _mm_set_epi64x( 0x0c0d0e0f08090a0bULL,
+                                            0x0405060700010203ULL ) );
+
+   __m128i state0( _mm_loadu_si128( reinterpret_cast< __m128i const* >( state ) ) );
+   __m128i state1( _mm_loadu_si128( reinterpret_cast< __m128i const* >( state + 4 ) ) );
+   toAbefShaNi( state0, state1 );
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += 64 )
+   {
+      __m128i const* input( reinterpret_cast< __m128i const* >( blocks ) );
+      sha256ChunkShaNi( state0, state1,
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 0 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 1 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 2 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 3 ), bswapMask ) );
+   }
+
+   fromAbefShaNi( state0, state1 );
+   _mm_storeu_si128( reinterpret_cast< __m128i* >( state ), state0 );
+   _mm_storeu_si128( reinterpret_cast< __m128i* >( state + 4 ), state1 );
+}
+
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256 compression of a run of all-zero chunks with the Intel SHA
+ *         extensions.
+ *
+ *  The schedule of a zero chunk is all zeros : each pair of rounds takes K
+ *  as is, without loading, shuffling or expanding message words.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" )
+inline void
+sha256ZeroBlocksShaNi( std::uint32_t* state, std::uint64_t nbOfBlocks )
+{
+   __m128i state0( _mm_loadu_si128( reinterpret_cast< __m128i const* >( state ) ) );
+   __m128i state1( _mm_loadu_si128( reinterpret_cast< __m128i const* >( state + 4 ) ) );
+   toAbefShaNi( state0, state1 );
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks )
+   {
+      sha256KnownChunkShaNi( state0, state1, SHA256::K.data() );
+   }
+
+   fromAbefShaNi( state0, state1 );
+   _mm_storeu_si128( reinterpret_cast< __m128i* >( state ), state0 );
+   _mm_storeu_si128( reinterpret_cast< __m128i* >( state + 4 ), state1 );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256( SHA256( x ) ) of lanes contiguous 64 bytes inputs, each
+ *         step done for every input before the next step.
+ *
+ *  init0 / init1 are the initial values, ABEF / CDGH.  The padding chunk of
+ *  the inner hash goes through its precomputed schedule.  The inner digest
+ *  stays in registers : shuffled back to ABCD / EFGH, its two halves are the
+ *  first eight message words of the outer hash, whose last eight are
+ *  constants.
+ */
+template< std::size_t lanes >
+HDQRT_TARGET( "sha,sse4.1,ssse3" ) ALWAYS_INLINE void
+sha256d64LanesShaNi( std::uint8_t const* inputs, std::uint8_t* digests,
+                     __m128i init0, __m128i init1 )
+{
+   __m128i const bswapMask( _mm_set_epi64x( 0x0c0d0e0f08090a0bULL,
+                                            0x0405060700010203ULL ) );
+   __m128i const outerPad0( _mm_set_epi32( 0, 0, 0, static_cast< int >( 0x80000000 ) ) );
+   __m128i const outerPad1( _mm_set_epi32( 256, 0, 0, 0 ) );
+
+   __m128i state0[lanes], state1[lanes];
+   for( std::size_t lane( 0 ); lane != lanes; ++lane )
+   {
+      __m128i const* input( reinterpret_cast< __m128i const* >( inputs + lane * 64 ) );
+      state0[lane] = init0;
+      state1[lane] = init1;
+      sha256ChunkShaNi( state0[lane], state1[lane],
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 0 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 1 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 2 ), bswapMask ),
+                        _mm_shuffle_epi8( _mm_loadu_si128( input + 3 ), bswapMask ) );
+   }
+   for( std::size_t lane( 0 ); lane != lanes; ++lane )
+   {
+      sha256KnownChunkShaNi( state0[lane], state1[lane], sha256_padding64_kw.data() );
+      fromAbefShaNi( state0[lane], state1[lane] );
+   }
+
+   __m128i outer0[lanes], outer1[lanes];
+   for( std::size_t lane( 0 ); lane != lanes; ++lane )
+   {
+      outer0[lane] = init0;
+      outer1[lane] = init1;
+      sha256ChunkShaNi( outer0[lane], outer1[lane], state0[lane], state1[lane],
+                        outerPad0, outerPad1 );
+   }
+   for( std::size_t lane( 0 ); lane != lanes; ++lane )
+   {
+      fromAbefShaNi( outer0[lane], outer1[lane] );
+      __m128i* digest( reinterpret_cast< __m128i* >( digests + lane * 32 ) );
+      _mm_storeu_si128( digest + 0, _mm_shuffle_epi8( outer0[lane], bswapMask ) );
+      _mm_storeu_si128( digest + 1, _mm_shuffle_epi8( outer1[lane], bswapMask ) );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256( SHA256( x ) ) of nbOfInputs contiguous 64 bytes inputs
+ *         with the Intel SHA extensions.
+ *
+ *  Only call when cpu::hasShaNi() is true.  The inputs go two at a time :
+ *  a single chain of sha256rnds2 is bound by their latency, two independent
+ *  ones keep the unit busy.
+ */
+HDQRT_TARGET( "sha,sse4.1,ssse3" )
+inline void
+sha256d64ShaNi( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   __m128i init0( _mm_loadu_si128( reinterpret_cast< __m128i const* >(
+                                      SHA256::initHashVals.data() ) ) );
+   __m128i init1( _mm_loadu_si128( reinterpret_cast< __m128i const* >(
+                                      SHA256::initHashVals.data() + 4 ) ) );
+   toAbefShaNi( init0, init1 );
+
+   for( ; nbOfInputs >= 2; nbOfInputs -= 2, inputs += 2 * 64, digests += 2 * 32 )
+   {
+      sha256d64LanesShaNi< 2 >( inputs, digests, init0, init1 );
+   }
+   if( nbOfInputs != 0 )
+   {
+      sha256d64LanesShaNi< 1 >( inputs, digests, init0, init1 );
+   }
+}
+
+} // namespace details
+
+} // namespace hashes
+
+#endif // HDQRT_X86_BACKENDS
@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <cstddef> // for std::size_t
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+#if HDQRT_X86_BACKENDS
+#  include <immintrin.h>
+
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Rotate right each 32 bits lane.
+ */
+template< int moves >
+HDQRT_TARGET( "ssse3" ) ALWAYS_INLINE __m128i rotateRightX4( __m128i x )
+{
+   return _mm_or_si128( _mm_srli_epi32( x, moves ), _mm_slli_epi32( x, 32 - moves ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256 sigma1 (minuscule, one) of the four lanes.
+ */
+HDQRT_TARGET( "ssse3" ) ALWAYS_INLINE __m128i sigma1X4( __m128i x )
+{
+   return _mm_xor_si128( _mm_xor_si128( rotateRightX4<17>( x ), rotateRightX4<19>( x ) ),
+                         _mm_srli_epi32( x, 10 ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Next four words of the SHA256 message schedule.
+ *
+ *  x0 to x3 hold W[t-16] to W[t-1], four words each.  W[t+2] and W[t+3] need
+ *  sigma1 of W[t] and W[t+1], so sigma1 is applied to the low half first and
+ *  then to the freshly computed words moved to the high half.
+ */
+HDQRT_TARGET( "ssse3" ) ALWAYS_INLINE __m128i
+nextScheduleX4( __m128i x0, __m128i x1, __m128i x2, __m128i x3 )
+{
+   __m128i w15( _mm_alignr_epi8( x1, x0, 4 ) );   // W[t-15] .. W[t-12]
+   __m128i w7( _mm_alignr_epi8( x3, x2, 4 ) );    // W[t-7]  .. W[t-4]
+
+   __m128i s0( _mm_xor_si128( _mm_xor_si128( rotateRightX4<7>( w15 ),
+                                             rotateRightX4<18>( w15 ) ),
+                              _mm_srli_epi32( w15, 3 ) ) );
+
+   __m128i w( _mm_add_epi32( _mm_add_epi32( x0, s0 ), w7 ) );
+
+   // W[t], W[t+1] from W[t-2], W[t-1]
+   w = _mm_add_epi32( w, sigma1X4( _mm_srli_si128( x3, 8 ) ) );
+   // W[t+2], W[t+3] from W[t], W[t+1]
+   return _mm_add_epi32( w, sigma1X4( _mm_slli_si128( w, 8 ) ) );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256 compression of a run of chunks, schedule computed with SSSE3.
+ *
+ *  Only call when cpu::hasSsse3() is true.  For CPUs without the SHA
+ *  extensions.  The 16 input words are loaded and byte swapped with shuffles,
+ *  the message schedule is computed four words at a time in vector registers
+ *  and added to K there, and the rounds stay scalar.  The vector work for the
+ *  next four words is independent of the four rounds that consume the current
+ *  ones, so the CPU overlaps both.
+ */
+HDQRT_TARGET( "ssse3" )
+inline void
+sha256BlocksSsse3( std::uint32_t* state, std::uint8_t const* blocks,
+                   std::size_t nbOfBlocks )
+{
+   typedef SHA256 Algo;
+   typedef std::uint32_t word_t;
+
+   __m128i const bswapMask( _mm_set_epi64x( 0x0c0d0e0f08090a0bULL,
+                                            0x0405060700010203ULL ) );
+   __m128i const* k( reinterpret_cast< __m128i const* >( Algo::K.data() ) );
+
+   word_t a( state[0] ), b( state[1] ), c( state[2] ), d( state[3] ),
+          e( state[4] ), f( state[5] ), g( state[6] ), h( state[7] );
+
+   alignas( 16 ) word_t wk[4];
+
+   for( ; nbOfBlocks != 0; --nbOfBlocks, blocks += 64 )
+   {
+      __m128i const* input( reinterpret_cast< __m128i const* >( blocks ) );
+      __m128i x0( _mm_shuffle_epi8( _mm_loadu_si128( input + 0 ), bswapMask ) );
+      __m128i x1( _mm_shuffle_epi8( _mm_loadu_si128( input + 1 ), bswapMask ) );
+      __m128i x2( _mm_shuffle_epi8( _mm_loadu_si128( input + 2 ), bswapMask ) );
+      __m128i x3( _mm_shuffle_epi8( _mm_loadu_si128( input + 3 ), bswapMask ) );
+
+      word_t const aSave( a ), bSave( b ), cSave( c ), dSave( d ),
+                   eSave( e ), fSave( f ), gSave( g ), hSave( h );
+
+      for( int group( 0 ); group != 16; ++group )
+      {
+         _mm_store_si128( reinterpret_cast< __m128i* >( wk ),
+                          _mm_add_epi32( x0, _mm_loadu_si128( k + group ) ) );
+
+         if( group < 12 )
+         {
+            __m128i next( nextScheduleX4( x0, x1, x2, x3 ) );
+            x0 = x1;
+            x1 = x2;
+            x2 = x3;
+            x3 = next;
+         }
+         else
+         {
+            x0 = x1;
+            x1 = x2;
+            x2 = x3;
+         }
+
+         for( int idx( 0 ); idx != 4; ++idx )
+         {
+            word_t T1( h + Sigma1<Algo>( e ) + Ch( e, f, g ) + wk[idx] );
+            word_t T2( Sigma0<Algo>( a ) + Maj( a, b, c ) );
+            h = g;
+            g = f;
+            f = e;
+            e = d + T1;
+            d = c;
+            c = b;
+            b = a;
+            a = T1 + T2;
+         }
+      }
+
+      a += aSave; b += bSave; c += cSave; d += dSave;
+      e += eSave; f += fSave; g += gSave; h += hSave;
+   }
+
+   state[0] = a; state[1] = b; state[2] = c; state[3] = d;
+   state[4] = e; state[5] = f; state[6] = g; state[7] = h;
+}
+
+} // namespace details
+
+} // namespace hashes
+
+#endif // HDQRT_X86_BACKENDS
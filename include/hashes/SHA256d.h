@@ -0,0 +1,29 @@
+#ifndef HDQRT_HASH_SHA256D_H_
+#define HDQRT_HASH_SHA256D_H_
+
+#include <cstdint>
+#include <cstddef> // for std::size_t
+#include <string_view>
+
+#include "../hashes.h"
+
+namespace hashes
+{
+
+using sha256d64_fn = void (*)( std::uint8_t const* inputs, std::size_t nbOfInputs,
+                               std::uint8_t* digests );
+
+sha256d64_fn backendSha256d64( Backend backend );
+
+void sha256d64( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests );
+
+Digest<SHA256> sha256d( std::uint8_t const* input, std::size_t len );
+
+Digest<SHA256> sha256d( std::string_view input );
+
+
+} // namespace hashes
+
+#include "SHA256d.inl"
+
+#endif // HDQRT_HASH_SHA256D_H_
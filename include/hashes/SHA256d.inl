@@ -0,0 +1,214 @@
+#include <array>
+
+#include "../always_inline.h"
+#include "../cpu.h"
+
+namespace hashes
+{
+
+namespace details
+{
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Portable SHA256( SHA256( x ) ) of contiguous 64 bytes inputs.
+ *
+ *  The padding chunk of the inner hash runs with its schedule as a constant,
+ *  folded into the rounds by the compiler.  The inner state is used as is
+ *  for the first eight words of the outer chunk : no digest is written in
+ *  between.  Always inlined so that each backend compiles it with its own
+ *  target instruction set.
+ */
+ALWAYS_INLINE void
+sha256d64Portable( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   typedef Hash<SHA256>::hash_type hash_type;
+
+   for( ; nbOfInputs != 0; --nbOfInputs, inputs += 64, digests += 32 )
+   {
+      schedule_words< SHA256, RollingSchedule >::type W;
+      prepareSchedule<SHA256>( W, inputs, RollingSchedule() );
+
+      hash_type inner( SHA256::initHashVals );
+      sha2Rounds<SHA256>( inner, W, UnrolledRounds(), RollingSchedule() );
+      sha2Rounds<SHA256>( inner, sha256_padding64_w, UnrolledRounds(), FullSchedule() );
+
+      W = { { inner[0], inner[1], inner[2], inner[3], inner[4], inner[5], inner[6], inner[7],
+              0x80000000, 0, 0, 0, 0, 0, 0, 256 } };
+      hash_type outer( SHA256::initHashVals );
+      sha2Rounds<SHA256>( outer, W, UnrolledRounds(), RollingSchedule() );
+
+      bits::store_be( digests, outer.data(), outer.size() );
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+inline void
+scalarSha256d64( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   sha256d64Portable( inputs, nbOfInputs, digests );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Kernel of the first of preferred, BMI2 and scalar the CPU has a
+ *         sha256d64 kernel for.
+ */
+inline sha256d64_fn
+firstSha256d64( Backend preferred )
+{
+   for( Backend backend : { preferred, Backend::BMI2, Backend::SCALAR } )
+   {
+      if( sha256d64_fn const kernel = backendSha256d64( backend ) ) { return kernel; }
+   }
+   return &scalarSha256d64;
+}
+
+
+
+#if HDQRT_X86_BACKENDS
+//------------------------------------------------------------------------------
+HDQRT_TARGET( "bmi,bmi2" )
+inline void
+bmi2Sha256d64( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   sha256d64Portable( inputs, nbOfInputs, digests );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Groups of 8 inputs through the AVX2 kernel, the rest through the
+ *         kernel of the backend processBlocks uses, or BMI2 or scalar when
+ *         that backend has none (SSSE3).
+ */
+inline void
+avx2Sha256d64( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   for( ; nbOfInputs >= 8; nbOfInputs -= 8, inputs += 8 * 64, digests += 8 * 32 )
+   {
+      sha256d64x8Avx2( inputs, digests );
+   }
+
+   if( nbOfInputs != 0 )
+   {
+      static sha256d64_fn const rest( firstSha256d64( selectedBackend<SHA256>() ) );
+      rest( inputs, nbOfInputs, digests );
+   }
+}
+#endif
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief Kernel of the backend hashBatch uses for SHA256, or the portable
+ *         one when that backend has no sha256d64 kernel (SSSE3).
+ */
+inline sha256d64_fn
+selectSha256d64()
+{
+   return firstSha256d64( batchBackend<SHA256>() );
+}
+
+} // namespace details
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief sha256d64 kernel of a backend, null when the backend has none or
+ *         the CPU does not support it.
+ *
+ *  SHA-NI and the portable kernels (scalar, BMI2) work on one input at a
+ *  time, AVX2 on 8 inputs side by side.  SSSE3 has no such kernel.
+ */
+inline sha256d64_fn
+backendSha256d64( Backend backend )
+{
+   switch( backend )
+   {
+      case Backend::SCALAR:
+         return &details::scalarSha256d64;
+#if HDQRT_X86_BACKENDS
+      case Backend::BMI2:
+         return cpu::hasBmi2() ? &details::bmi2Sha256d64 : nullptr;
+      case Backend::SHA_NI:
+         return cpu::hasShaNi() ? &details::sha256d64ShaNi : nullptr;
+      case Backend::AVX2:
+         return cpu::hasAvx2() ? &details::avx2Sha256d64 : nullptr;
+#endif
+      default:
+         return nullptr;
+   }
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256( SHA256( x ) ) of nbOfInputs contiguous 64 bytes inputs,
+ *         as nbOfInputs contiguous 32 bytes digests.
+ *
+ *  Meant for Merkle trees : the digests of a level, read two by two, are
+ *  the inputs of the next one, and digests may be inputs to reduce a level
+ *  in place.  The kernel is bound on the first call, for the backend
+ *  batchBackend<SHA256> selects.  Does not allocate.
+ */
+inline void
+sha256d64( std::uint8_t const* inputs, std::size_t nbOfInputs, std::uint8_t* digests )
+{
+   static sha256d64_fn const selected( details::selectSha256d64() );
+   selected( inputs, nbOfInputs, digests );
+}
+
+
+
+//------------------------------------------------------------------------------
+/*!
+ *  @brief SHA256( SHA256( x ) ) of a message of any length.
+ *
+ *  The inner state is written straight into the only chunk of the outer
+ *  hash, over a padding which never changes.  A 64 bytes message goes
+ *  through sha256d64.  Does not allocate.
+ */
+inline Digest<SHA256>
+sha256d( std::uint8_t const* input, std::size_t len )
+{
+   Digest<SHA256> digest;
+   if( len == 64 )
+   {
+      sha256d64( input, 1, digest.bytes.data() );
+      return digest;
+   }
+
+   Hash<SHA256> theHash;
+   details::hashMessage<SHA256>( theHash, input, len );
+
+   // 32 bytes of digest, the 1 bit, and a length of 256 bits
+   std::array< std::uint8_t, 64 > chunk{};
+   bits::store_be( chunk.data(), theHash.state.data(), theHash.state.size() );
+   chunk[32] = 0x80;
+   chunk[62] = 0x01;
+
+   initializeHash<SHA256>( theHash );
+   hashes::processBlocks<SHA256>( theHash.state, chunk.data(), 1 );
+   getDigest<SHA256>( theHash, digest );
+   return digest;
+}
+
+
+
+//------------------------------------------------------------------------------
+ALWAYS_INLINE Digest<SHA256>
+sha256d( std::string_view input )
+{
+   return sha256d( reinterpret_cast< std::uint8_t const* >( input.data() ), input.size() );
+}
+
+} // namespace hashes
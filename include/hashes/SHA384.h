@@ -15,7 +15,7 @@ struct SHA384 : public SHA512
    typedef SHA512 family;
 
    typedef typename SHA512::word_t word_t;
-   static constexpr std::uint_fast16_t nb_of_sha_vars = SHA256::nb_of_sha_vars;
+   static constexpr std::uint_fast16_t nb_of_sha_vars = SHA512::nb_of_sha_vars;
 
    static constexpr uint_fast16_t rounds = SHA512::rounds;
    static constexpr uint_fast32_t chunk_size = SHA512::chunk_size;
@@ -19,10 +19,17 @@ struct SHA512_224 : public SHA512
    static constexpr uint_fast16_t rounds = SHA512::rounds;
    static constexpr uint_fast32_t chunk_size = SHA512::chunk_size;
    static constexpr std::uint_fast16_t len_encode_len = SHA512::len_encode_len;
+
+   static constexpr std::array< word_t, 8 > initHashVals = { {
+                            0x8c3d37c819544da2, 0x73e1996689dcd4d6,
+                            0x1dfab7ae32ff9c82, 0x679dd514582f9fcf,
+                            0x0f6d2b697bd44da8, 0x77e36f7304c48942,
+                            0x3f9d85a86a1d36c8, 0x1112e6ad91d692a1  } };
+
    static constexpr std::uint_fast16_t digest_len = 224;
 };
-//constexpr std::array< typename SHA512_224::word_t, 8 > SHA512_224::initHashVals;
-//constexpr std::array< typename SHA512_224::word_t, SHA512_224::rounds > SHA512_224::K;
+
+constexpr std::array< typename SHA512_224::word_t, 8 > SHA512_224::initHashVals;
 
 } // namespace hashes
 
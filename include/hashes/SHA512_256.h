@@ -19,10 +19,17 @@ struct SHA512_256 : public SHA512
    static constexpr uint_fast16_t rounds = SHA512::rounds;
    static constexpr uint_fast32_t chunk_size = SHA512::chunk_size;
    static constexpr std::uint_fast16_t len_encode_len = SHA512::len_encode_len;
+
+   static constexpr std::array< word_t, 8 > initHashVals = { {
+                            0x22312194fc2bf72c, 0x9f555fa3c84c64c2,
+                            0x2393b86b6f53b151, 0x963877195940eabd,
+                            0x96283ee2a88effe3, 0xbe5e1e2553863992,
+                            0x2b0199fc2c85b8aa, 0x0eb72ddc81c52ca2  } };
+
    static constexpr std::uint_fast16_t digest_len = 256;
 };
-//constexpr std::array< typename SHA512_256::word_t, 8 > SHA512_256::initHashVals;
-//constexpr std::array< typename SHA512_256::word_t, SHA512_256::rounds > SHA512_256::K;
+
+constexpr std::array< typename SHA512_256::word_t, 8 > SHA512_256::initHashVals;
 
 
 } // namespace hashes
@@ -8,6 +8,13 @@
 #include <iomanip>
 #include <string>
 #include <bitset>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+#include <thread>
+#include <memory>
 
 #include "hashes.h"
 #include "bits.h"
@@ -36,6 +43,107 @@ BOOST_AUTO_TEST_CASE( bit_fn_tests )
 
 }
 
+BOOST_AUTO_TEST_CASE( byte_order )
+{
+   static_assert( bits::endianness() == bits::native_endianness, "" );
+   static_assert( bits::byte_swap( std::uint32_t( 0x01020304 ) ) == 0x04030201, "" );
+   static_assert( bits::byte_swap( std::uint64_t( 0x0102030405060708 ) ) == 0x0807060504030201, "" );
+   static_assert( bits::byte_swap( std::uint16_t( 0x0102 ) ) == 0x0201, "" );
+   BOOST_CHECK( bits::endianness() != bits::Endianness::UNKNOWN );
+
+   std::uint8_t const bytes[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                                  0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 };
+   BOOST_CHECK_EQUAL( bits::load_be32( bytes + 1 ), 0x02030405u );
+   BOOST_CHECK_EQUAL( bits::load_be64( bytes + 3 ), 0x0405060708090a0bull );
+
+   std::uint8_t out[16] = {};
+   bits::store_be32( out + 1, 0xa1b2c3d4 );
+   BOOST_CHECK_EQUAL( out[1], 0xa1 );
+   BOOST_CHECK_EQUAL( out[4], 0xd4 );
+   bits::store_be64( out + 7, 0x1122334455667788 );
+   BOOST_CHECK_EQUAL( out[7], 0x11 );
+   BOOST_CHECK_EQUAL( out[14], 0x88 );
+   BOOST_CHECK_EQUAL( bits::unpack( std::uint32_t( 0x0a659420 ) )[1], 0x65 );
+
+   // Bulk versions, around the vector widths, unaligned, round trip
+   std::vector< std::uint8_t > src( 8 * 13 + 1 );
+   for( std::size_t idx( 0 ); idx != src.size(); ++idx )
+   {
+      src[idx] = static_cast< std::uint8_t >( idx * 53 + 1 );
+   }
+   for( std::size_t count( 0 ); count <= 13; ++count )
+   {
+      std::vector< std::uint64_t > words64( count );
+      bits::load_be( words64.data(), src.data() + 1, count );
+      std::vector< std::uint32_t > words32( 2 * count );
+      bits::load_be( words32.data(), src.data() + 1, 2 * count );
+      for( std::size_t idx( 0 ); idx != count; ++idx )
+      {
+         BOOST_CHECK_EQUAL( words64[idx], bits::load_be64( src.data() + 1 + 8 * idx ) );
+         BOOST_CHECK_EQUAL( words32[2 * idx], bits::load_be32( src.data() + 1 + 8 * idx ) );
+         BOOST_CHECK_EQUAL( words32[2 * idx + 1], bits::load_be32( src.data() + 5 + 8 * idx ) );
+      }
+
+      std::vector< std::uint8_t > back64( 8 * count + 1 ), back32( 8 * count + 1 );
+      bits::store_be( back64.data() + 1, words64.data(), count );
+      bits::store_be( back32.data() + 1, words32.data(), 2 * count );
+      BOOST_CHECK( std::equal( back64.begin() + 1, back64.end(), src.begin() + 1 ) );
+      BOOST_CHECK( std::equal( back32.begin() + 1, back32.end(), src.begin() + 1 ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( hex_encoding )
+{
+   BOOST_CHECK_EQUAL( bits::to_hex( std::uint8_t( 0xa5 ) ), "a5" );
+   BOOST_CHECK_EQUAL( bits::to_hex( std::uint16_t( 0x0102 ) ), "0102" );
+   BOOST_CHECK_EQUAL( bits::to_hex( std::uint32_t( 0xdeadbeef ) ), "deadbeef" );
+   BOOST_CHECK_EQUAL( bits::to_hex( std::uint64_t( 0x0123456789abcdef ) ), "0123456789abcdef" );
+
+   // Every length around the 16 and 32 bytes vector widths, against the table
+   std::vector< std::uint8_t > bytes( 100 );
+   for( std::size_t idx( 0 ); idx != bytes.size(); ++idx )
+   {
+      bytes[idx] = static_cast< std::uint8_t >( idx * 37 + 11 );
+   }
+   for( std::size_t len( 0 ); len <= bytes.size(); ++len )
+   {
+      std::string expected( 2 * len, '\0' ), encoded( 2 * len + 1, '#' );
+      bits::details::toHexTable( bytes.data(), len, &expected[0] );
+      char* end( bits::to_hex( bytes.data(), len, &encoded[0] ) );
+      BOOST_CHECK( end == &encoded[0] + 2 * len );
+      BOOST_CHECK_EQUAL( encoded.back(), '#' );
+      encoded.pop_back();
+      BOOST_CHECK_EQUAL( expected, encoded );
+
+#if HDQRT_X86_BACKENDS
+      if( cpu::hasSsse3() )
+      {
+         bits::details::toHexSsse3( bytes.data(), len, &encoded[0] );
+         BOOST_CHECK_EQUAL( expected, encoded );
+      }
+      if( cpu::hasAvx2() )
+      {
+         bits::details::toHexAvx2( bytes.data(), len, &encoded[0] );
+         BOOST_CHECK_EQUAL( expected, encoded );
+      }
+#endif
+
+      std::vector< std::uint8_t > decoded( len );
+      BOOST_CHECK( bits::from_hex( encoded, decoded.data() ) );
+      BOOST_CHECK( std::equal( decoded.begin(), decoded.end(), bytes.begin() ) );
+   }
+
+   std::uint8_t decoded[4] = { 0, 0, 0, 0 };
+   BOOST_CHECK( bits::from_hex( "DeadBEEF", decoded ) );
+   BOOST_CHECK_EQUAL( decoded[0], 0xde );
+   BOOST_CHECK_EQUAL( decoded[3], 0xef );
+   BOOST_CHECK( !bits::from_hex( "abc", decoded ) );
+   BOOST_CHECK( !bits::from_hex( "0g", decoded ) );
+   BOOST_CHECK( !bits::from_hex( "0x12", decoded ) );
+   BOOST_CHECK( !bits::from_hex( std::string_view( "12\0" "4", 4 ), decoded ) );
+   BOOST_CHECK( bits::from_hex( "", decoded ) );
+}
+
 
 // BOOST_AUTO_TEST_CASE( hex_fns )
 // {
@@ -96,23 +204,1363 @@ BOOST_AUTO_TEST_CASE( hash_fns )
 
    BOOST_CHECK_EQUAL( "152b616fae41298a64df8d248edbd2a8cdf01384c5b2440a360a499a35f92690",
                       hashes::hashStrg<hashes::SHA256>( strgToHash ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( sha2_family_kats )
+{
+   std::string const abc( "abc" );
+   std::string const msg448( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" );
+   std::string const msg896( "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+                             "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu" );
+   // 111 and 112 bytes : last size fitting in one SHA512 chunk and first one
+   // needing a second padding chunk
+   std::string const a111( 111, 'a' ), a112( 112, 'a' );
+
+   // SHA224
+   BOOST_CHECK_EQUAL( "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f",
+                      hashes::hashStrg<hashes::SHA224>( "" ) );
+   BOOST_CHECK_EQUAL( "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7",
+                      hashes::hashStrg<hashes::SHA224>( abc ) );
+   BOOST_CHECK_EQUAL( "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525",
+                      hashes::hashStrg<hashes::SHA224>( msg448 ) );
+   BOOST_CHECK_EQUAL( "c97ca9a559850ce97a04a96def6d99a9e0e0e2ab14e6b8df265fc0b3",
+                      hashes::hashStrg<hashes::SHA224>( msg896 ) );
+   BOOST_CHECK_EQUAL( "4aeec1a49b2c1bc663abf2809b36faaa64359523d4f26d02dbc2cba3",
+                      hashes::hashStrg<hashes::SHA224>( a111 ) );
+   BOOST_CHECK_EQUAL( "0336b66821946e7f1052102e3b9c29f3039efe9b261746370305f894",
+                      hashes::hashStrg<hashes::SHA224>( a112 ) );
+
+   // SHA256
+   BOOST_CHECK_EQUAL( "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+                      hashes::hashStrg<hashes::SHA256>( "" ) );
+   BOOST_CHECK_EQUAL( "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+                      hashes::hashStrg<hashes::SHA256>( abc ) );
+   BOOST_CHECK_EQUAL( "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+                      hashes::hashStrg<hashes::SHA256>( msg448 ) );
+   BOOST_CHECK_EQUAL( "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+                      hashes::hashStrg<hashes::SHA256>( msg896 ) );
+   BOOST_CHECK_EQUAL( "6374f73208854473827f6f6a3f43b1f53eaa3b82c21c1a6d69a2110b2a79baad",
+                      hashes::hashStrg<hashes::SHA256>( a111 ) );
+   BOOST_CHECK_EQUAL( "f54353008a2553262ecdc4a34749563ba0950e8b0fc8652780b0a614b99683c1",
+                      hashes::hashStrg<hashes::SHA256>( a112 ) );
+
+   // SHA384
+   BOOST_CHECK_EQUAL( "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da"
+                      "274edebfe76f65fbd51ad2f14898b95b",
+                      hashes::hashStrg<hashes::SHA384>( "" ) );
+   BOOST_CHECK_EQUAL( "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+                      "8086072ba1e7cc2358baeca134c825a7",
+                      hashes::hashStrg<hashes::SHA384>( abc ) );
+   BOOST_CHECK_EQUAL( "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6"
+                      "b0455a8520bc4e6f5fe95b1fe3c8452b",
+                      hashes::hashStrg<hashes::SHA384>( msg448 ) );
+   BOOST_CHECK_EQUAL( "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712"
+                      "fcc7c71a557e2db966c3e9fa91746039",
+                      hashes::hashStrg<hashes::SHA384>( msg896 ) );
+   BOOST_CHECK_EQUAL( "3c37955051cb5c3026f94d551d5b5e2ac38d572ae4e07172085fed81f8466b8f"
+                      "90dc23a8ffcdea0b8d8e58e8fdacc80a",
+                      hashes::hashStrg<hashes::SHA384>( a111 ) );
+   BOOST_CHECK_EQUAL( "187d4e07cb306103c69967bf544d0dfbe9042577599c73c330abc0cb64c61236"
+                      "d5ed565ee19119d8c31779a38f791fcd",
+                      hashes::hashStrg<hashes::SHA384>( a112 ) );
+
+   // SHA512
+   BOOST_CHECK_EQUAL( "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+                      "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e",
+                      hashes::hashStrg<hashes::SHA512>( "" ) );
+   BOOST_CHECK_EQUAL( "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                      "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+                      hashes::hashStrg<hashes::SHA512>( abc ) );
+   BOOST_CHECK_EQUAL( "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+                      "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445",
+                      hashes::hashStrg<hashes::SHA512>( msg448 ) );
+   BOOST_CHECK_EQUAL( "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+                      "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909",
+                      hashes::hashStrg<hashes::SHA512>( msg896 ) );
+   BOOST_CHECK_EQUAL( "fa9121c7b32b9e01733d034cfc78cbf67f926c7ed83e82200ef8681819692176"
+                      "0b4beff48404df811b953828274461673c68d04e297b0eb7b2b4d60fc6b566a2",
+                      hashes::hashStrg<hashes::SHA512>( a111 ) );
+   BOOST_CHECK_EQUAL( "c01d080efd492776a1c43bd23dd99d0a2e626d481e16782e75d54c2503b5dc32"
+                      "bd05f0f1ba33e568b88fd2d970929b719ecbb152f58f130a407c8830604b70ca",
+                      hashes::hashStrg<hashes::SHA512>( a112 ) );
+
+   // SHA512/224
+   BOOST_CHECK_EQUAL( "6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4",
+                      hashes::hashStrg<hashes::SHA512_224>( "" ) );
+   BOOST_CHECK_EQUAL( "4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa",
+                      hashes::hashStrg<hashes::SHA512_224>( abc ) );
+   BOOST_CHECK_EQUAL( "e5302d6d54bb242275d1e7622d68df6eb02dedd13f564c13dbda2174",
+                      hashes::hashStrg<hashes::SHA512_224>( msg448 ) );
+   BOOST_CHECK_EQUAL( "23fec5bb94d60b23308192640b0c453335d664734fe40e7268674af9",
+                      hashes::hashStrg<hashes::SHA512_224>( msg896 ) );
+   BOOST_CHECK_EQUAL( "3ebe1b48e8c66acb9ae014db95b4bec93de7e9572bff41cf566bd7d0",
+                      hashes::hashStrg<hashes::SHA512_224>( a111 ) );
+   BOOST_CHECK_EQUAL( "79b41fef2a0439d2705724a67615f7bcbcd2bf5664a7774b80818eb6",
+                      hashes::hashStrg<hashes::SHA512_224>( a112 ) );
+
+   // SHA512/256
+   BOOST_CHECK_EQUAL( "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a",
+                      hashes::hashStrg<hashes::SHA512_256>( "" ) );
+   BOOST_CHECK_EQUAL( "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23",
+                      hashes::hashStrg<hashes::SHA512_256>( abc ) );
+   BOOST_CHECK_EQUAL( "bde8e1f9f19bb9fd3406c90ec6bc47bd36d8ada9f11880dbc8a22a7078b6a461",
+                      hashes::hashStrg<hashes::SHA512_256>( msg448 ) );
+   BOOST_CHECK_EQUAL( "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a",
+                      hashes::hashStrg<hashes::SHA512_256>( msg896 ) );
+   BOOST_CHECK_EQUAL( "0239e429f98d0ed61ee8e2a7c30afe98c1c3a80ce5dff62a107e9c538f7632ce",
+                      hashes::hashStrg<hashes::SHA512_256>( a111 ) );
+   BOOST_CHECK_EQUAL( "9216b5303edb66504570bee90e48ea5beaa5e9fe9f760bbd3e0460559fc005f6",
+                      hashes::hashStrg<hashes::SHA512_256>( a112 ) );
+
+   // The 128 bits length encoding also goes through the incremental hasher
+   hashes::Hasher<hashes::SHA384> hasher;
+   for( char c : msg896 ) { hasher.update( &c, 1 ); }
+   BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA384>( msg896 ), hasher.finalize() );
+}
+
+
+BOOST_AUTO_TEST_CASE( md5_kats )
+{
+   // RFC 1321 test suite
+   BOOST_CHECK_EQUAL( "d41d8cd98f00b204e9800998ecf8427e", hashes::hashStrg<hashes::MD5>( "" ) );
+   BOOST_CHECK_EQUAL( "0cc175b9c0f1b6a831c399e269772661", hashes::hashStrg<hashes::MD5>( "a" ) );
+   BOOST_CHECK_EQUAL( "900150983cd24fb0d6963f7d28e17f72", hashes::hashStrg<hashes::MD5>( "abc" ) );
+   BOOST_CHECK_EQUAL( "f96b697d7cb7938d525a2f31aaf161d0",
+                      hashes::hashStrg<hashes::MD5>( "message digest" ) );
+   BOOST_CHECK_EQUAL( "c3fcd3d76192e4007dfb496cca67e13b",
+                      hashes::hashStrg<hashes::MD5>( "abcdefghijklmnopqrstuvwxyz" ) );
+   BOOST_CHECK_EQUAL( "d174ab98d277d9f5a5611c2c9f419d9f",
+                      hashes::hashStrg<hashes::MD5>(
+                         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789" ) );
+   BOOST_CHECK_EQUAL( "57edf4a22be3c955ac49da2e2107b67a",
+                      hashes::hashStrg<hashes::MD5>( "1234567890123456789012345678901234567890"
+                                                     "1234567890123456789012345678901234567890" ) );
+
+   // Padding boundaries and several chunks
+   BOOST_CHECK_EQUAL( "ef1772b6dff9a122358552954ad0df65",
+                      hashes::hashStrg<hashes::MD5>( std::string( 55, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "3b0c8ac703f828b04c6c197006d17218",
+                      hashes::hashStrg<hashes::MD5>( std::string( 56, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "b06521f39153d618550606be297466d5",
+                      hashes::hashStrg<hashes::MD5>( std::string( 63, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "014842d480b571495a4a0363793f7367",
+                      hashes::hashStrg<hashes::MD5>( std::string( 64, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "cabe45dcc9ae5b66ba86600cca6b8ba8",
+                      hashes::hashStrg<hashes::MD5>( std::string( 1000, 'a' ) ) );
+
+   // Digest bytes are little endian words of the state
+   auto const digest( hashes::hashDigest<hashes::MD5>( "abc" ) );
+   BOOST_CHECK_EQUAL( digest.size, 16u );
+   BOOST_CHECK_EQUAL( digest.bytes[0], 0x90 );
+   BOOST_CHECK_EQUAL( digest.bytes[15], 0x72 );
+
+   std::string const msg( 200, 'x' );
+   hashes::Hasher<hashes::MD5> hasher;
+   hasher.update( msg.substr( 0, 70 ) );
+   hasher.update( msg.substr( 70 ) );
+   BOOST_CHECK_EQUAL( hasher.finalize(), hashes::hashStrg<hashes::MD5>( msg ) );
+   BOOST_CHECK( hashes::selfTest<hashes::MD5>() );
+}
+
+
+BOOST_AUTO_TEST_CASE( padding_boundaries )
+{
+   // Tails of 56 bytes and more need a second padding chunk
+   BOOST_CHECK_EQUAL( "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 55, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 56, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 63, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 64, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "635361c48bb9eab14198e76ea8ab7f1a41685d6ad62aa9146d301d4f17eb0ae0",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 65, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "31eba51c313a5c08226adf18d4a359cfdfd8d2e816b13f4af952f7ea6584dcfb",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 119, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "6836cf13bac400e9105071cd6af47084dfacad4e5e302c94bfed24e013afb73e",
+                      hashes::hashStrg<hashes::SHA256>( std::string( 128, 'a' ) ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( incremental_hasher )
+{
+   std::string strgToHash( "Once Upon A Time is a rather interesting show.  "
+                           "I hope I will not get hooked on it, because I don't "
+                           "really have the time for another show." );
+
+   // Every split point gives the same digest as the one shot hash
+   for( std::size_t split( 0 ); split <= strgToHash.length(); ++split )
+   {
+      hashes::Hasher<hashes::SHA256> hasher;
+      hasher.update( strgToHash.substr( 0, split ) );
+      hasher.update( strgToHash.substr( split ) );
+      BOOST_CHECK_EQUAL( "152b616fae41298a64df8d248edbd2a8cdf01384c5b2440a360a499a35f92690",
+                         hasher.finalize() );
+   }
+
+   // Byte by byte, across the two padding chunks case
+   hashes::Hasher<hashes::SHA256> hasher;
+   for( std::size_t len( 0 ); len <= 130; ++len )
+   {
+      std::string msg( len, 'a' );
+      for( char c : msg ) { hasher.update( &c, 1 ); }
+      BOOST_CHECK_EQUAL( hasher.length(), len );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA256>( msg ), hasher.finalize() );
+   }
+
+   BOOST_CHECK_EQUAL( hasher.length(), 0u );
+   BOOST_CHECK_EQUAL( "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+                      hasher.finalize() );
+}
+
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Suffixes finished from a prefix snapshot, against hashing the whole
+// message, on both sides of every chunk and padding boundary.
+template< typename Algo >
+void checkSnapshots()
+{
+   constexpr std::size_t chunkBytes( hashes::Hasher<Algo>::chunk_bytes );
+   std::string text;
+   for( std::size_t idx( 0 ); idx != 7 * chunkBytes; ++idx )
+   {
+      text += static_cast< char >( 'a' + idx * 7 % 26 );
+   }
+
+   std::size_t const lengths[] = { 0, 1, chunkBytes / 2, chunkBytes - 9, chunkBytes - 1,
+                                   chunkBytes, chunkBytes + 1, 3 * chunkBytes + 5 };
+   for( std::size_t prefixLen : lengths )
+   {
+      hashes::Hasher<Algo> snapshot;
+      snapshot.update( std::string_view( text ).substr( 0, prefixLen ) );
+
+      for( std::size_t suffixLen : lengths )
+      {
+         std::string_view const suffix( text.data() + prefixLen, suffixLen );
+         std::string const expected(
+                           hashes::hashStrg<Algo>( text.substr( 0, prefixLen + suffixLen ) ) );
+
+         BOOST_CHECK_EQUAL( snapshot.finalizeWith( suffix ), expected );
+         BOOST_CHECK_EQUAL( snapshot.fork().update( suffix ).finalize(), expected );
+      }
+      BOOST_CHECK_EQUAL( snapshot.length(), prefixLen );
+   }
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( prefix_snapshots )
+{
+   checkSnapshots<hashes::MD5>();
+   checkSnapshots<hashes::SHA1>();
+   checkSnapshots<hashes::SHA256>();
+   checkSnapshots<hashes::SHA512>();
+
+   // Records sharing a header, finished from one snapshot by several threads
+   std::string const header( 1000, 'h' );
+   hashes::Hasher<hashes::SHA256> snapshot;
+   snapshot.update( header );
+
+   std::size_t const nbOfRecords( 64 );
+   std::vector< std::string > digests( nbOfRecords );
+   std::vector< std::thread > threads;
+   for( std::size_t first( 0 ); first != 4; ++first )
+   {
+      threads.emplace_back( [&, first]()
+      {
+         for( std::size_t record( first ); record < nbOfRecords; record += 4 )
+         {
+            digests[record] = snapshot.finalizeWith( std::to_string( record ) );
+         }
+      } );
+   }
+   for( std::thread& thread : threads ) { thread.join(); }
+
+   for( std::size_t record( 0 ); record != nbOfRecords; ++record )
+   {
+      BOOST_CHECK_EQUAL( digests[record],
+                         hashes::hashStrg<hashes::SHA256>( header + std::to_string( record ) ) );
+   }
+}
+
+
+BOOST_AUTO_TEST_CASE( input_views )
+{
+   std::string abc( "abc" );
+   std::string const abcDigest(
+         "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+
+   std::uint8_t const abcArray[] = { 'a', 'b', 'c' };
+   std::vector< std::uint8_t > abcVector( abc.begin(), abc.end() );
+   std::vector< std::byte > abcBytes{ std::byte( 'a' ), std::byte( 'b' ),
+                                      std::byte( 'c' ) };
+
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( abc ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( "abc" ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( std::string_view( abc ) ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( abcArray ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( abcArray, 3 ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( abcVector ) );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>( abcBytes ) );
+
+   // Chunks are read from anywhere in the caller's memory
+   std::string padded( "xabc" );
+   BOOST_CHECK_EQUAL( abcDigest, hashes::hashStrg<hashes::SHA256>(
+                           std::string_view( padded ).substr( 1 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( digest_type )
+{
+   static_assert( hashes::Digest<hashes::SHA256>::size == 32, "SHA256 digest is 32 bytes" );
+   static_assert( hashes::Digest<hashes::SHA512_224>::hex_size == 56, "SHA512/224 digest is 56 hex chars" );
+
+   hashes::Digest<hashes::SHA256> abc( hashes::hashDigest<hashes::SHA256>( "abc" ) );
+   BOOST_CHECK_EQUAL( abc.hex(), hashes::hashStrg<hashes::SHA256>( "abc" ) );
+   BOOST_CHECK_EQUAL( abc.bytes[0], 0xba );
+   BOOST_CHECK_EQUAL( abc.bytes[31], 0xad );
+
+   hashes::Digest<hashes::SHA384> abc384( hashes::hashDigest<hashes::SHA384>( "abc" ) );
+   BOOST_CHECK_EQUAL( abc384.hex(), hashes::hashStrg<hashes::SHA384>( "abc" ) );
+
+   // Caller buffer versions
+   char hex[hashes::Digest<hashes::SHA224>::hex_size];
+   std::string_view msg( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" );
+   char* end( hashes::hashStrg<hashes::SHA224>(
+                  reinterpret_cast< std::uint8_t const* >( msg.data() ), msg.size(), hex ) );
+   BOOST_CHECK( end == hex + sizeof( hex ) );
+   BOOST_CHECK_EQUAL( std::string( hex, sizeof( hex ) ),
+                      hashes::hashStrg<hashes::SHA224>( msg ) );
+
+   hashes::Hasher<hashes::SHA224> hasher;
+   hashes::Digest<hashes::SHA224> streamed;
+   hasher.update( msg );
+   hasher.finalize( streamed );
+   BOOST_CHECK_EQUAL( streamed.hex(), std::string( hex, sizeof( hex ) ) );
+
+   // Parsing, both cases, and rejection of bad input
+   hashes::Digest<hashes::SHA256> parsed;
+   BOOST_CHECK( hashes::Digest<hashes::SHA256>::fromHex(
+         "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD", parsed ) );
+   BOOST_CHECK( parsed == abc );
+   BOOST_CHECK( !hashes::Digest<hashes::SHA256>::fromHex( "ba7816bf", parsed ) );
+   BOOST_CHECK( !hashes::Digest<hashes::SHA256>::fromHex(
+         "za7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", parsed ) );
+
+   // Ordering follows the hex representation
+   hashes::Digest<hashes::SHA256> empty( hashes::hashDigest<hashes::SHA256>( "" ) );
+   BOOST_CHECK( abc != empty );
+   BOOST_CHECK_EQUAL( abc < empty, abc.hex() < empty.hex() );
+   BOOST_CHECK_EQUAL( abc > empty, abc.hex() > empty.hex() );
+   BOOST_CHECK( abc <= abc );
+   BOOST_CHECK( abc >= abc );
+   BOOST_CHECK( !( abc < abc ) );
+
+   std::ostringstream ostrm;
+   ostrm << abc;
+   BOOST_CHECK_EQUAL( ostrm.str(), abc.hex() );
+
+   std::unordered_set< hashes::Digest<hashes::SHA256> > seen;
+   seen.insert( abc );
+   seen.insert( empty );
+   seen.insert( hashes::hashDigest<hashes::SHA256>( "abc" ) );
+   BOOST_CHECK_EQUAL( seen.size(), 2u );
+}
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Digest from a hex literal, at compile time.
+template< typename Algo >
+constexpr hashes::Digest<Algo> digestOf( std::string_view hex )
+{
+   hashes::Digest<Algo> digest{};
+   hashes::Digest<Algo>::fromHex( hex, digest );
+   return digest;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( compile_time_hashing )
+{
+   using hashes::SHA224;
+   using hashes::SHA256;
+   using hashes::SHA384;
+   using hashes::SHA512;
+   namespace ct = hashes::ct;
+
+   static_assert( ct::sha256( "" ) == digestOf<SHA256>(
+         "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" ), "" );
+   static_assert( ct::sha256( "abc" ) == digestOf<SHA256>(
+         "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" ), "" );
+   static_assert( ct::sha256( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) ==
+         digestOf<SHA256>( "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" ), "" );
+   static_assert( ct::sha224( "abc" ) == digestOf<SHA224>(
+         "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7" ), "" );
+   static_assert( ct::sha384( "abc" ) == digestOf<SHA384>(
+         "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+         "8086072ba1e7cc2358baeca134c825a7" ), "" );
+   static_assert( ct::sha512( "abc" ) == digestOf<SHA512>(
+         "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+         "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" ), "" );
+   static_assert( ct::sha256( "abc" ) != ct::sha256( "abd" ), "" );
+
+   // As a template argument
+   BOOST_CHECK_EQUAL( ( std::integral_constant< std::uint8_t, ct::sha256( "abc" ).bytes[0] >::value ),
+                      0xba );
+
+   // Lengths around the padding boundaries of both chunk sizes, against the
+   // runtime kernels
+   std::string msg;
+   for( std::size_t len( 0 ); len != 260; ++len )
+   {
+      BOOST_CHECK( ct::sha256( msg ) == hashes::hashDigest<SHA256>( msg ) );
+      BOOST_CHECK( ct::sha384( msg ) == hashes::hashDigest<SHA384>( msg ) );
+      BOOST_CHECK( ct::hash<hashes::SHA512_256>( msg ) ==
+                   hashes::hashDigest<hashes::SHA512_256>( msg ) );
+      msg.push_back( static_cast< char >( len * 7 ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( multi_block_kernel )
+{
+   std::vector< std::uint8_t > blocks( 5 * 64 );
+   for( std::size_t idx( 0 ); idx != blocks.size(); ++idx )
+   {
+      blocks[idx] = static_cast< std::uint8_t >( idx * 7 + 3 );
+   }
+
+   // One call over the whole run matches one call per chunk
+   hashes::Hash<hashes::SHA256> oneByOne, allAtOnce;
+   hashes::initializeHash( oneByOne );
+   hashes::initializeHash( allAtOnce );
+
+   for( std::size_t idx( 0 ); idx != 5; ++idx )
+   {
+      hashes::processChunk( oneByOne, blocks.data() + idx * 64 );
+   }
+   hashes::processBlocks<hashes::SHA256>( allAtOnce.state, blocks.data(), 5 );
+   BOOST_CHECK( oneByOne.state == allAtOnce.state );
+
+   // Zero blocks leaves the state untouched
+   hashes::processBlocks<hashes::SHA256>( allAtOnce.state, blocks.data(), 0 );
+   BOOST_CHECK( oneByOne.state == allAtOnce.state );
+
+   // Unrolled rounds match the reference loop, for both word sizes
+   using hashes::details::LoopRounds;
+   using hashes::details::UnrolledRounds;
+   hashes::Hash<hashes::SHA256> loop256, unrolled256;
+   hashes::initializeHash( loop256 );
+   hashes::initializeHash( unrolled256 );
+   hashes::details::processBlocks< hashes::SHA256, LoopRounds >(
+                        loop256.state, blocks.data(), 5, std::true_type() );
+   hashes::details::processBlocks< hashes::SHA256, UnrolledRounds >(
+                        unrolled256.state, blocks.data(), 5, std::true_type() );
+   BOOST_CHECK( loop256.state == unrolled256.state );
+
+   hashes::Hash<hashes::SHA512> loop512, unrolled512;
+   hashes::initializeHash( loop512 );
+   hashes::initializeHash( unrolled512 );
+   hashes::details::processBlocks< hashes::SHA512, LoopRounds >(
+                        loop512.state, blocks.data(), 2, std::true_type() );
+   hashes::details::processBlocks< hashes::SHA512, UnrolledRounds >(
+                        unrolled512.state, blocks.data(), 2, std::true_type() );
+   BOOST_CHECK( loop512.state == unrolled512.state );
+
+   // The 16 word rolling schedule matches the full one
+   using hashes::details::RollingSchedule;
+   hashes::Hash<hashes::SHA256> rolling256, rollingLoop256;
+   hashes::initializeHash( rolling256 );
+   hashes::initializeHash( rollingLoop256 );
+   hashes::details::processBlocks< hashes::SHA256, UnrolledRounds, RollingSchedule >(
+                        rolling256.state, blocks.data(), 5, std::true_type() );
+   hashes::details::processBlocks< hashes::SHA256, LoopRounds, RollingSchedule >(
+                        rollingLoop256.state, blocks.data(), 5, std::true_type() );
+   BOOST_CHECK( rolling256.state == unrolled256.state );
+   BOOST_CHECK( rollingLoop256.state == unrolled256.state );
+
+   hashes::Hash<hashes::SHA512> rolling512, rollingLoop512;
+   hashes::initializeHash( rolling512 );
+   hashes::initializeHash( rollingLoop512 );
+   hashes::details::processBlocks< hashes::SHA512, UnrolledRounds, RollingSchedule >(
+                        rolling512.state, blocks.data(), 2, std::true_type() );
+   hashes::details::processBlocks< hashes::SHA512, LoopRounds, RollingSchedule >(
+                        rollingLoop512.state, blocks.data(), 2, std::true_type() );
+   BOOST_CHECK( rolling512.state == unrolled512.state );
+   BOOST_CHECK( rollingLoop512.state == unrolled512.state );
+}
+
+namespace
+{
+
+typedef hashes::blocks_fn<hashes::SHA256> sha256_kernel;
+
+//------------------------------------------------------------------------------
+// Hash a message through the given chunk kernel (64 bytes chunks).
+template< typename Algo = hashes::SHA256 >
+std::string hashWithKernel( hashes::blocks_fn<Algo> kernel, std::string const& msg )
+{
+   auto input = reinterpret_cast< std::uint8_t const* >( msg.data() );
+   std::size_t nbOfChunks( msg.length() / 64 );
+
+   hashes::Hash<Algo> theHash;
+   hashes::initializeHash( theHash );
+   kernel( theHash.state, input, nbOfChunks );
+
+   hashes::LastChunks<Algo> lastChunks;
+   nbOfChunks = hashes::padLastChunk<Algo>( lastChunks,
+                     input + nbOfChunks * 64, msg.length() % 64, msg.length() );
+   kernel( theHash.state, lastChunks.data(), nbOfChunks );
+
+   return hashes::getDigest( theHash );
+}
+
+//------------------------------------------------------------------------------
+// Known answers every SHA256 backend must reproduce.
+void checkSha256Kernel( sha256_kernel kernel )
+{
+   BOOST_CHECK_EQUAL( "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+                      hashWithKernel( kernel, "" ) );
+   BOOST_CHECK_EQUAL( "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+                      hashWithKernel( kernel, "abc" ) );
+   BOOST_CHECK_EQUAL( "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+                      hashWithKernel( kernel, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) );
+   BOOST_CHECK_EQUAL( "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a",
+                      hashWithKernel( kernel, std::string( 56, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "6836cf13bac400e9105071cd6af47084dfacad4e5e302c94bfed24e013afb73e",
+                      hashWithKernel( kernel, std::string( 128, 'a' ) ) );
+   BOOST_CHECK_EQUAL( "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+                      hashWithKernel( kernel, std::string( 1000000, 'a' ) ) );
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( sha256_backends )
+{
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::BMI2,
+                                    hashes::Backend::SSSE3, hashes::Backend::SHA_NI } )
+   {
+      sha256_kernel kernel( hashes::backendBlocks<hashes::SHA256>( backend ) );
+      if( kernel != nullptr )
+      {
+         BOOST_TEST_MESSAGE( "Testing the " << hashes::backendName( backend ) << " backend." );
+         checkSha256Kernel( kernel );
+      }
+      else
+      {
+         BOOST_TEST_MESSAGE( hashes::backendName( backend ) << " not available, backend not tested." );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE( sha1_backends )
+{
+   using hashes::SHA1;
+   std::string const msg448( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" );
+   std::string const msg896( "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+                             "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu" );
+
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::SHA_NI } )
+   {
+      hashes::blocks_fn<SHA1> kernel( hashes::backendBlocks<SHA1>( backend ) );
+      if( kernel == nullptr )
+      {
+         BOOST_TEST_MESSAGE( hashes::backendName( backend ) << " not available, backend not tested." );
+         continue;
+      }
+
+      BOOST_TEST_MESSAGE( "Testing the " << hashes::backendName( backend ) << " backend." );
+      BOOST_CHECK_EQUAL( "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+                         hashWithKernel<SHA1>( kernel, "" ) );
+      BOOST_CHECK_EQUAL( "a9993e364706816aba3e25717850c26c9cd0d89d",
+                         hashWithKernel<SHA1>( kernel, "abc" ) );
+      BOOST_CHECK_EQUAL( "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+                         hashWithKernel<SHA1>( kernel, msg448 ) );
+      BOOST_CHECK_EQUAL( "a49b2446a02c645bf419f995b67091253a04a259",
+                         hashWithKernel<SHA1>( kernel, msg896 ) );
+      BOOST_CHECK_EQUAL( "c1c8bbdc22796e28c0e15163d20899b65621d65a",
+                         hashWithKernel<SHA1>( kernel, std::string( 55, 'a' ) ) );
+      BOOST_CHECK_EQUAL( "c2db330f6083854c99d4b5bfb6e8f29f201be699",
+                         hashWithKernel<SHA1>( kernel, std::string( 56, 'a' ) ) );
+      BOOST_CHECK_EQUAL( "0098ba824b5c16427bd7a1122a5a442a25ec644d",
+                         hashWithKernel<SHA1>( kernel, std::string( 64, 'a' ) ) );
+      BOOST_CHECK_EQUAL( "34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+                         hashWithKernel<SHA1>( kernel, std::string( 1000000, 'a' ) ) );
+   }
+
+   // Through the dispatch : git object id of an empty blob and of a file
+   BOOST_CHECK_EQUAL( "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391",
+                      hashes::hashStrg<SHA1>( std::string( "blob 0\0", 7 ) ) );
+   BOOST_CHECK_EQUAL( "3b18e512dba79e4c8300dd08aeb37f8e728b8dad",
+                      hashes::hashStrg<SHA1>( std::string( "blob 12\0hello world\n", 20 ) ) );
+   BOOST_CHECK_EQUAL( hashes::hashDigest<SHA1>( "abc" ).size, 20u );
+   BOOST_CHECK( hashes::selfTest<SHA1>() );
+}
+
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Hasher::updateZeros against update with a buffer of zeros, after prefixes
+// that leave the internal buffer empty, partly filled or one byte short.
+template< typename Algo >
+void checkUpdateZeros()
+{
+   constexpr std::size_t chunkBytes( hashes::Hasher<Algo>::chunk_bytes );
+   std::string const zeros( 5 * chunkBytes + 3, '\0' );
+
+   for( std::size_t prefixLen : { std::size_t( 0 ), std::size_t( 1 ), chunkBytes - 1, chunkBytes } )
+   {
+      std::string const prefix( prefixLen, 'p' );
+      for( std::size_t count : { std::size_t( 0 ), std::size_t( 1 ), chunkBytes - prefixLen % chunkBytes,
+                                 chunkBytes, 3 * chunkBytes + 7, zeros.size() } )
+      {
+         hashes::Hasher<Algo> expected;
+         expected.update( prefix ).update( zeros.data(), count ).update( "s" );
+         hashes::Hasher<Algo> hasher;
+         hasher.update( prefix ).updateZeros( count ).update( "s" );
+         BOOST_CHECK_EQUAL( hasher.length(), expected.length() );
+         BOOST_CHECK_EQUAL( hasher.finalize(), expected.finalize() );
+      }
+   }
+}
+
+} // namespace
+
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Keys and messages of the RFC 4231 test cases 1 to 7.
+std::vector< std::pair< std::string, std::string > > rfc4231Cases()
+{
+   std::string key4;
+   for( char byte( 1 ); byte != 26; ++byte ) { key4 += byte; }
+
+   return {
+      { std::string( 20, '\x0b' ), "Hi There" },
+      { "Jefe", "what do ya want for nothing?" },
+      { std::string( 20, '\xaa' ), std::string( 50, '\xdd' ) },
+      { key4, std::string( 50, '\xcd' ) },
+      { std::string( 20, '\x0c' ), "Test With Truncation" },
+      { std::string( 131, '\xaa' ), "Test Using Larger Than Block-Size Key - Hash Key First" },
+      { std::string( 131, '\xaa' ),
+        "This is a test using a larger than block-size key and a larger than block-size data. "
+        "The key needs to be hashed before being used by the HMAC algorithm." } };
+}
+
+
+
+//------------------------------------------------------------------------------
+// One shot, streamed in pieces and batched HMAC against the expected values.
+// Test case 5 only checks the first 128 bits.
+template< typename Algo >
+void checkHmac( std::vector< std::string > const& expected )
+{
+   auto const cases( rfc4231Cases() );
+   std::vector< std::string_view > msgs;
+   for( std::size_t idx( 0 ); idx != cases.size(); ++idx )
+   {
+      hashes::Hmac<Algo> hmac( cases[idx].first );
+      std::string const& msg( cases[idx].second );
+      std::size_t const checked( idx == 4 ? 32 : expected[idx].size() );
+
+      BOOST_CHECK_EQUAL( hmac.mac( msg ).substr( 0, checked ), expected[idx] );
+
+      for( std::size_t split : { std::size_t( 0 ), std::size_t( 1 ), msg.size() / 2, msg.size() } )
+      {
+         hmac.update( msg.substr( 0, split ) ).update( msg.substr( split ) );
+         BOOST_CHECK_EQUAL( hmac.finalize().substr( 0, checked ), expected[idx] );
+      }
+
+      // The same key a second time : the states are kept, not consumed
+      std::vector< hashes::Digest<Algo> > const batch(
+                     hmac.macBatch( { msg, std::string_view(), msg } ) );
+      BOOST_CHECK_EQUAL( batch[0].hex().substr( 0, checked ), expected[idx] );
+      BOOST_CHECK( batch[0] == batch[2] );
+      BOOST_CHECK_EQUAL( batch[1].hex(), hmac.mac( std::string_view() ) );
+   }
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( hmac_rfc4231 )
+{
+   checkHmac<hashes::SHA224>( {
+         "896fb1128abbdf196832107cd49df33f47b4b1169912ba4f53684b22",
+         "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44",
+         "7fb3cb3588c6c1f6ffa9694d7d6ad2649365b0c1f65d69d1ec8333ea",
+         "6c11506874013cac6a2abc1bb382627cec6a90d86efc012de7afec5a",
+         "0e2aea68a90c8d37c988bcdb9fca6fa8",
+         "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e",
+         "3a854166ac5d9f023f54d517d0b39dbd946770db9c2b95c9f6f565d1" } );
+   checkHmac<hashes::SHA256>( {
+         "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+         "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+         "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+         "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+         "a3b6167473100ee06e0c796c2955552b",
+         "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+         "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2" } );
+   checkHmac<hashes::SHA384>( {
+         "afd03944d84895626b0825f4ab46907f15f9dadbe4101ec682aa034c7cebc59c"
+         "faea9ea9076ede7f4af152e8b2fa9cb6",
+         "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e"
+         "8e2240ca5e69e2c78b3239ecfab21649",
+         "88062608d3e6ad8a0aa2ace014c8a86f0aa635d947ac9febe83ef4e55966144b"
+         "2a5ab39dc13814b94e3ab6e101a34f27",
+         "3e8a69b7783c25851933ab6290af6ca77a9981480850009cc5577c6e1f573b4e"
+         "6801dd23c4a7d679ccf8a386c674cffb",
+         "3abf34c3503b2a23a46efc619baef897",
+         "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c6"
+         "0c2ef6ab4030fe8296248df163f44952",
+         "6617178e941f020d351e2f254e8fd32c602420feb0b8fb9adccebb82461e99c5"
+         "a678cc31e799176d3860e6110c46523e" } );
+   checkHmac<hashes::SHA512>( {
+         "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+         "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854",
+         "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+         "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737",
+         "fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39"
+         "bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb",
+         "b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3db"
+         "a91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd",
+         "415fad6271580a531d4179bc891d87a6",
+         "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+         "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598",
+         "e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944"
+         "b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58" } );
+
+   // RFC 2202, test cases 1 and 2
+   BOOST_CHECK_EQUAL( "9294727a3638bb1c13f48ef8158bfc9d",
+                      hashes::Hmac<hashes::MD5>( std::string( 16, '\x0b' ) ).mac( "Hi There" ) );
+   BOOST_CHECK_EQUAL( "750c783e6ab0b503eaa86e310a5db738",
+                      hashes::Hmac<hashes::MD5>( "Jefe" ).mac( "what do ya want for nothing?" ) );
+   BOOST_CHECK_EQUAL( "b617318655057264e28bc0b6fb378c8ef146be00",
+                      hashes::Hmac<hashes::SHA1>( std::string( 20, '\x0b' ) ).mac( "Hi There" ) );
+   BOOST_CHECK_EQUAL( "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+                      hashes::Hmac<hashes::SHA1>( "Jefe" ).mac( "what do ya want for nothing?" ) );
+
+   // A new key drops the message being streamed
+   hashes::Hmac<hashes::SHA256> hmac( "Jefe" );
+   hmac.update( "garbage" );
+   hmac.setKey( "Jefe", 4 );
+   hmac.update( "what do ya want for nothing?" );
+   BOOST_CHECK_EQUAL( hmac.finalize(),
+                      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" );
+}
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Hex PBKDF2 key, computed by the given number of threads.
+template< typename Algo >
+std::string pbkdf2Hex( std::string_view password, std::string_view salt,
+                       std::uint32_t iterations, std::size_t keyLen, unsigned threads = 0 )
+{
+   std::vector< std::uint8_t > const key(
+                     hashes::pbkdf2<Algo>( password, salt, iterations, keyLen, threads ) );
+   std::string hex( 2 * key.size(), '\0' );
+   bits::details::toHexTable( key.data(), key.size(), &hex[0] );
+   return hex;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( pbkdf2_vectors )
+{
+   // RFC 6070, without the 16777216 iterations case
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA1>( "password", "salt", 1, 20 ),
+                      "0c60c80f961f0e71f3a9b524af6012062fe037a6" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA1>( "password", "salt", 2, 20 ),
+                      "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA1>( "password", "salt", 4096, 20 ),
+                      "4b007901b765489abead49d926f721d065a429c1" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA1>( "passwordPASSWORDpassword",
+                                               "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25 ),
+                      "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA1>( std::string_view( "pass\0word", 9 ),
+                                               std::string_view( "sa\0lt", 5 ), 4096, 16 ),
+                      "56fa6aa75548099dcc37d7f03425e0c3" );
+
+   // RFC 7914, section 11
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA256>( "passwd", "salt", 1, 64 ),
+                      "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+                      "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA256>( "Password", "NaCl", 80000, 64 ),
+                      "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56"
+                      "a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d" );
+
+   // Keys of several digests with a partial last block, one thread or many
+   std::string const sha512Key(
+         "afe6c5530785b6cc6b1c6453384731bd5ee432ee549fd42fb6695779ad8a1c5b"
+         "f59de69c48f774efc4007d5298f9033c0241d5ab69305e7b64eceeb8d834cfec"
+         "6afdec3c1c23982a121f2d4be008889378a49a0dfb104f0d2856e38f44271cda"
+         "f6de434196647bc5673cd6c148611ced6e9003b65879feccc89226ecc5e22090"
+         "795445cc7314fcf414878a42ffd39cd3b90dcd41e065" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA512>( "password", "salt", 1000, 150, 1 ), sha512Key );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA512>( "password", "salt", 1000, 150, 3 ), sha512Key );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::SHA384>( "password", "salt", 10, 100, 4 ),
+                      "e03f8ca570b98475a9bcd7f73442f3990c3ec87f8815478954ceb62ac2f3d709"
+                      "891aadcb5f5c9485c13e79e20a46a146715b0231c7053a060af9a52a85dee7b5"
+                      "4cba7254a44c93666ff08a77731e05d14c9bedbe2f2883d8a0e09b28d4c9b4b1"
+                      "54714396" );
+   BOOST_CHECK_EQUAL( pbkdf2Hex<hashes::MD5>( "password", "salt", 3, 40 ),
+                      "f6acd4bda3e4d3d831a5f61da9ca9d5c3877566e979f4928778d81be4f2e9433"
+                      "a31043bbf3945c35" );
+
+   BOOST_CHECK( hashes::pbkdf2<hashes::SHA256>( "password", "salt", 1, 0 ).empty() );
+   BOOST_CHECK_THROW( hashes::pbkdf2<hashes::SHA256>( "password", "salt", 0, 32 ),
+                      std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( zero_blocks )
+{
+   BOOST_CHECK_EQUAL( "f5a5fd42d16a20302798ef6ed309979b43003d2320d9f0e8ea9831a92759fb4b",
+                      hashes::Hasher<hashes::SHA256>().updateZeros( 64 ).finalize() );
+
+   checkUpdateZeros<hashes::MD5>();
+   checkUpdateZeros<hashes::SHA1>();
+   checkUpdateZeros<hashes::SHA256>();
+   checkUpdateZeros<hashes::SHA224>();
+   checkUpdateZeros<hashes::SHA512>();
+   checkUpdateZeros<hashes::SHA384>();
+
+   // Every zero chunks kernel against its backend on real zeros
+   std::string const zeros( 9 * 128, '\0' );
+   auto const input( reinterpret_cast< std::uint8_t const* >( zeros.data() ) );
+   for( hashes::Backend backend : { hashes::Backend::SCALAR, hashes::Backend::BMI2,
+                                    hashes::Backend::SSSE3, hashes::Backend::SHA_NI } )
+   {
+      hashes::blocks_fn<hashes::SHA256> blocks( hashes::backendBlocks<hashes::SHA256>( backend ) );
+      hashes::zero_blocks_fn<hashes::SHA256> zeroBlocks(
+                              hashes::backendZeroBlocks<hashes::SHA256>( backend ) );
+      BOOST_CHECK_EQUAL( blocks == nullptr, zeroBlocks == nullptr );
+      if( blocks == nullptr ) { continue; }
+
+      hashes::Hash<hashes::SHA256> expected, theHash;
+      hashes::initializeHash( expected );
+      hashes::initializeHash( theHash );
+      blocks( expected.state, input, 9 );
+      zeroBlocks( theHash.state, 9 );
+      BOOST_CHECK( theHash.state == expected.state );
+
+      hashes::blocks_fn<hashes::SHA512> blocks512( hashes::backendBlocks<hashes::SHA512>( backend ) );
+      if( blocks512 == nullptr ) { continue; }
+      hashes::Hash<hashes::SHA512> expected512, theHash512;
+      hashes::initializeHash( expected512 );
+      hashes::initializeHash( theHash512 );
+      blocks512( expected512.state, input, 9 );
+      hashes::backendZeroBlocks<hashes::SHA512>( backend )( theHash512.state, 9 );
+      BOOST_CHECK( theHash512.state == expected512.state );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( backend_dispatch )
+{
+   // Every available backend agrees with the scalar one
+   BOOST_CHECK( hashes::selfTest() );
+
+   BOOST_CHECK( hashes::backendBlocks<hashes::SHA512>( hashes::Backend::SCALAR ) != nullptr );
+   BOOST_CHECK( hashes::backendBlocks<hashes::SHA512>( hashes::Backend::SHA_NI ) == nullptr );
+   BOOST_CHECK( hashes::backendBlocks<hashes::SHA256>( hashes::Backend::AVX2 ) == nullptr );
+   BOOST_CHECK( hashes::backendBlocks<hashes::SHA256>(
+                     hashes::selectedBackend<hashes::SHA256>() ) != nullptr );
+
+   hashes::Backend backend( hashes::Backend::SCALAR );
+   BOOST_CHECK( hashes::backendFromName( "sha-ni", backend ) );
+   BOOST_CHECK( backend == hashes::Backend::SHA_NI );
+   BOOST_CHECK( !hashes::backendFromName( "sse9", backend ) );
+   BOOST_CHECK( backend == hashes::Backend::SHA_NI );
+   BOOST_CHECK_EQUAL( std::string( "ssse3" ), hashes::backendName( hashes::Backend::SSSE3 ) );
+
+   // Forcing a backend, as the environment variable does
+   using hashes::details::selectBackend;
+   BOOST_CHECK( selectBackend<hashes::SHA256>( "scalar" ) == hashes::Backend::SCALAR );
+   BOOST_CHECK( selectBackend<hashes::SHA512>( "scalar" ) == hashes::Backend::SCALAR );
+   BOOST_CHECK( selectBackend<hashes::SHA256>( "unknown" ) ==
+                selectBackend<hashes::SHA256>( nullptr ) );
+   if( cpu::hasSsse3() )
+   {
+      BOOST_CHECK( selectBackend<hashes::SHA224>( "ssse3" ) == hashes::Backend::SSSE3 );
+   }
+   // Not implemented for SHA512 : falls back on the best one
+   BOOST_CHECK( selectBackend<hashes::SHA512>( "sha-ni" ) ==
+                selectBackend<hashes::SHA512>( nullptr ) );
+   if( cpu::hasAvx2() )
+   {
+      BOOST_CHECK( hashes::details::selectBatchBackend<hashes::SHA256>( "avx2" ) ==
+                   hashes::Backend::AVX2 );
+   }
+   BOOST_CHECK( hashes::details::selectBatchBackend<hashes::SHA256>( "scalar" ) ==
+                hashes::Backend::SCALAR );
+}
+
+BOOST_AUTO_TEST_CASE( batch_hashing )
+{
+   // Different lengths keep the lanes out of step and cover both padding cases
+   std::vector< std::string > messages;
+   for( std::size_t len( 0 ); len < 300; len += 7 )
+   {
+      messages.push_back( std::string( len, static_cast< char >( 'a' + len % 26 ) ) );
+   }
+   std::vector< std::string_view > inputs( messages.begin(), messages.end() );
+
+   std::vector< std::string > digests( hashes::hashBatch<hashes::SHA256>( inputs ) );
+   BOOST_REQUIRE_EQUAL( digests.size(), messages.size() );
+   for( std::size_t idx( 0 ); idx != messages.size(); ++idx )
+   {
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA256>( messages[idx] ), digests[idx] );
+   }
+
+   std::vector< std::string > digests224( hashes::hashBatch<hashes::SHA224>( inputs ) );
+   std::vector< std::string > digests512( hashes::hashBatch<hashes::SHA512>( inputs ) );
+   for( std::size_t idx( 0 ); idx != messages.size(); ++idx )
+   {
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA224>( messages[idx] ), digests224[idx] );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA512>( messages[idx] ), digests512[idx] );
+   }
+
+   BOOST_CHECK( hashes::hashBatch<hashes::SHA256>( {} ).empty() );
+
+#if HDQRT_X86_BACKENDS
+   // Multi-buffer kernel directly, whichever path hashBatch picks on this CPU
+   if( cpu::hasAvx2() )
+   {
+      std::vector< std::string > x8Digests( messages.size() );
+      hashes::details::hashBatchX8<hashes::SHA256>( inputs, x8Digests );
+      for( std::size_t idx( 0 ); idx != messages.size(); ++idx )
+      {
+         BOOST_CHECK_EQUAL( digests[idx], x8Digests[idx] );
+      }
+
+      // Fewer messages than lanes
+      std::vector< std::string > fewDigests( 3 );
+      hashes::details::hashBatchX8<hashes::SHA224>(
+            std::vector< std::string_view >( inputs.begin(), inputs.begin() + 3 ),
+            fewDigests );
+      for( std::size_t idx( 0 ); idx != 3; ++idx )
+      {
+         BOOST_CHECK_EQUAL( digests224[idx], fewDigests[idx] );
+      }
+   }
+#endif
+}
+
+
+BOOST_AUTO_TEST_CASE( double_sha256 )
+{
+   BOOST_CHECK_EQUAL( hashes::sha256d( "hello" ).hex(),
+                      "9595c9df90075148eb06860365df33584b75bff782a510c6cd4883a419833d50" );
+   BOOST_CHECK_EQUAL( hashes::sha256d( "" ).hex(),
+                      "5df6e0e2761359d30a8275058e299fcc0381534545f55cf43e41983f5d4c9456" );
+
+   // Merkle style inputs : each one is two 32 bytes digests of the level below
+   std::size_t const nbOfInputs( 19 );
+   std::vector< std::uint8_t > inputs( 64 * nbOfInputs );
+   for( std::size_t idx( 0 ); idx != inputs.size(); ++idx )
+   {
+      inputs[idx] = static_cast< std::uint8_t >( idx );
+   }
+   BOOST_CHECK_EQUAL( hashes::sha256d( inputs.data(), 64 ).hex(),
+                      "01c9f464780a1b6af4eb400fe2f2896cfb2169f5a65701439e4c2c4e213903ef" );
+
+   std::vector< std::uint8_t > expected( 32 * nbOfInputs );
+   for( std::size_t idx( 0 ); idx != nbOfInputs; ++idx )
+   {
+      hashes::Digest<hashes::SHA256> const inner(
+                     hashes::hashDigest<hashes::SHA256>( inputs.data() + 64 * idx, 64 ) );
+      hashes::Digest<hashes::SHA256> const outer(
+                     hashes::hashDigest<hashes::SHA256>( inner.bytes.data(), inner.size ) );
+      std::copy( outer.bytes.begin(), outer.bytes.end(), expected.begin() + 32 * idx );
+   }
+
+   // Every kernel of this CPU, on fewer, as many and more inputs than lanes
+   std::vector< hashes::Backend > const backends = { hashes::Backend::SCALAR,
+                        hashes::Backend::BMI2, hashes::Backend::SHA_NI, hashes::Backend::AVX2 };
+   for( hashes::Backend backend : backends )
+   {
+      hashes::sha256d64_fn const kernel( hashes::backendSha256d64( backend ) );
+      if( kernel == nullptr ) { continue; }
+
+      for( std::size_t count : { 0u, 1u, 7u, 8u, 9u, 16u, 19u } )
+      {
+         std::vector< std::uint8_t > digests( 32 * nbOfInputs, 0 );
+         kernel( inputs.data(), count, digests.data() );
+         BOOST_CHECK( std::equal( digests.begin(), digests.begin() + 32 * count,
+                                  expected.begin() ) );
+         BOOST_CHECK( std::all_of( digests.begin() + 32 * count, digests.end(),
+                                   []( std::uint8_t byte ) { return byte == 0; } ) );
+      }
+   }
+   BOOST_CHECK( hashes::backendSha256d64( hashes::Backend::SSSE3 ) == nullptr );
+
+   std::vector< std::uint8_t > digests( 32 * nbOfInputs );
+   hashes::sha256d64( inputs.data(), nbOfInputs, digests.data() );
+   BOOST_CHECK( digests == expected );
+
+   // Root of a 16 leaves tree, one level at a time in place
+   std::vector< std::uint8_t > level( expected.begin(), expected.begin() + 32 * 16 );
+   for( std::size_t width( 16 ); width != 1; width /= 2 )
+   {
+      hashes::sha256d64( level.data(), width / 2, level.data() );
+   }
+   std::vector< std::uint8_t > node( expected.begin(), expected.begin() + 32 * 16 );
+   for( std::size_t width( 16 ); width != 1; width /= 2 )
+   {
+      for( std::size_t idx( 0 ); idx != width / 2; ++idx )
+      {
+         hashes::Digest<hashes::SHA256> const parent(
+                        hashes::sha256d( std::string_view(
+                              reinterpret_cast< char const* >( node.data() + 64 * idx ), 64 ) ) );
+         std::copy( parent.bytes.begin(), parent.bytes.end(), node.begin() + 32 * idx );
+      }
+   }
+   BOOST_CHECK( std::equal( level.begin(), level.begin() + 32, node.begin() ) );
+}
+
+#if HDQRT_POSIX_FILES
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Temporary file holding the given content, removed on destruction.
+struct TempFile
+{
+   explicit TempFile( std::string const& content )
+   {
+      char name[] = "/tmp/hdqrt_hash_XXXXXX";
+      int fd( ::mkstemp( name ) );
+      BOOST_REQUIRE( fd >= 0 );
+      path = name;
+      BOOST_REQUIRE( ::write( fd, content.data(), content.size() ) ==
+                     static_cast< ssize_t >( content.size() ) );
+      ::close( fd );
+   }
+   ~TempFile() { ::unlink( path.c_str() ); }
+
+   std::string path;
+};
+
+} // namespace
+
+
+BOOST_AUTO_TEST_CASE( file_hashing )
+{
+   std::string big( 5 * ( 1 << 20 ) + 37, '\0' );
+   for( std::size_t idx( 0 ); idx != big.size(); ++idx )
+   {
+      big[idx] = static_cast< char >( idx * 131 + idx / 4093 );
+   }
+
+   hashes::FileOptions smallWindows;
+   smallWindows.windowSize = 1;    // rounded up to one huge page
+   hashes::FileOptions populated;
+   populated.populate = true;
+   hashes::FileOptions readLoop;
+   readLoop.forceRead = true;
+   readLoop.bufferSize = 1000;     // rounded down to whole chunks
+
+   for( std::string const& content : { std::string(), std::string( "abc" ),
+                                       std::string( 1000, 'a' ), big } )
+   {
+      TempFile file( content );
+      std::string const expected( hashes::hashStrg<hashes::SHA256>( content ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, smallWindows ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, populated ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, readLoop ) );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA512>( content ),
+                         hashes::hashFile<hashes::SHA512>( file.path, smallWindows ) );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::MD5>( content ),
+                         hashes::hashFile<hashes::MD5>( file.path ) );
+   }
+
+   // Open regular file : hashed from its start, whatever its position
+   TempFile file( big );
+   int fd( ::open( file.path.c_str(), O_RDONLY ) );
+   BOOST_REQUIRE( fd >= 0 );
+   ::lseek( fd, 12345, SEEK_SET );
+   hashes::Digest<hashes::SHA256> digest;
+   hashes::hashFile<hashes::SHA256>( fd, digest );
+   BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( big ) );
+   ::lseek( fd, 12345, SEEK_SET );
+   hashes::hashFile<hashes::SHA256>( fd, digest, readLoop );
+   BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( big ) );
+   ::close( fd );
+
+   // Pipe : read until the end
+   int pipeFds[2];
+   BOOST_REQUIRE( ::pipe( pipeFds ) == 0 );
+   BOOST_REQUIRE( ::write( pipeFds[1], "abc", 3 ) == 3 );
+   ::close( pipeFds[1] );
+   hashes::hashFile<hashes::SHA256>( pipeFds[0], digest );
+   ::close( pipeFds[0] );
+   BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( "abc" ) );
+
+   BOOST_CHECK_THROW( hashes::hashFile<hashes::SHA256>( "/nonexistent/hdqrt_hash" ),
+                      std::system_error );
+}
+
+
+BOOST_AUTO_TEST_CASE( pipelined_file_hashing )
+{
+   std::string big( 3 * ( 1 << 20 ) + 101, '\0' );
+   for( std::size_t idx( 0 ); idx != big.size(); ++idx )
+   {
+      big[idx] = static_cast< char >( idx * 71 + idx / 8191 );
+   }
+
+   // Two small buffers : many hand overs, the reader often waits
+   hashes::FileOptions tightRing;
+   tightRing.pipelined = true;
+   tightRing.ringSlots = 2;
+   tightRing.bufferSize = 4096 + 100;
+   hashes::FileOptions defaultRing;
+   defaultRing.pipelined = true;
+
+   for( std::string const& content : { std::string(), std::string( "abc" ), big } )
+   {
+      TempFile file( content );
+      std::string const expected( hashes::hashStrg<hashes::SHA256>( content ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, tightRing ) );
+      BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, defaultRing ) );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA1>( content ),
+                         hashes::hashFile<hashes::SHA1>( file.path, tightRing ) );
+
+      int fd( ::open( file.path.c_str(), O_RDONLY ) );
+      BOOST_REQUIRE( fd >= 0 );
+      hashes::Digest<hashes::SHA512> digest;
+      hashes::PipelineStats stats;
+      hashes::hashFilePipelined<hashes::SHA512>( fd, digest, stats, tightRing );
+      ::close( fd );
+      BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA512>( content ) );
+      BOOST_CHECK_EQUAL( stats.bytes, content.size() );
+      BOOST_CHECK( stats.readerStalled.count() >= 0 );
+      BOOST_CHECK( stats.hasherStalled.count() >= 0 );
+   }
+
+   // Pipe fed by a writer thread, in pieces
+   int pipeFds[2];
+   BOOST_REQUIRE( ::pipe( pipeFds ) == 0 );
+   std::thread writer( [&]()
+   {
+      for( std::size_t done( 0 ); done < big.size(); done += 7000 )
+      {
+         std::size_t const len( std::min< std::size_t >( 7000, big.size() - done ) );
+         if( ::write( pipeFds[1], big.data() + done, len ) != static_cast< ssize_t >( len ) )
+         {
+            break;
+         }
+      }
+      ::close( pipeFds[1] );
+   } );
+   hashes::Digest<hashes::SHA256> digest;
+   hashes::PipelineStats stats;
+   hashes::hashFilePipelined<hashes::SHA256>( pipeFds[0], digest, stats, tightRing );
+   writer.join();
+   ::close( pipeFds[0] );
+   BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( big ) );
+   BOOST_CHECK_EQUAL( stats.bytes, big.size() );
+
+   // Read error : a directory cannot be read
+   int dirFd( ::open( "/tmp", O_RDONLY ) );
+   BOOST_REQUIRE( dirFd >= 0 );
+   BOOST_CHECK_THROW( hashes::hashFilePipelined<hashes::SHA256>( dirFd, digest, stats ),
+                      std::system_error );
+   ::close( dirFd );
+}
+
+
+BOOST_AUTO_TEST_CASE( uncached_file_hashing )
+{
+   std::string big( 3 * ( 1 << 20 ) + 101, '\0' );
+   for( std::size_t idx( 0 ); idx != big.size(); ++idx )
+   {
+      big[idx] = static_cast< char >( idx * 43 + idx / 5003 );
+   }
+
+   hashes::FileOptions direct;
+   direct.direct = true;
+   hashes::FileOptions dropCache;
+   dropCache.dropCache = true;
+   // One read in flight, buffers rounded down to the O_DIRECT alignment
+   hashes::FileOptions shallowDirect( direct );
+   shallowDirect.queueDepth = 1;
+   shallowDirect.bufferSize = 5000;
+   hashes::FileOptions shallowDrop( dropCache );
+   shallowDrop.queueDepth = 3;
+   shallowDrop.bufferSize = 5000;
+
+   // Unaligned tails, and files smaller than one aligned block
+   for( std::string const& content : { std::string(), std::string( "abc" ),
+                                       big.substr( 0, 4095 ), big.substr( 0, 4096 ),
+                                       big.substr( 0, 4097 ), big.substr( 0, 3 * 4096 + 64 ),
+                                       big } )
+   {
+      TempFile file( content );
+      std::string const expected( hashes::hashStrg<hashes::SHA256>( content ) );
+      for( hashes::FileOptions const* options : { &direct, &dropCache, &shallowDirect,
+                                                 &shallowDrop } )
+      {
+         BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, *options ) );
+      }
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA512>( content ),
+                         hashes::hashFile<hashes::SHA512>( file.path, shallowDirect ) );
+
+      // The descriptor is given back as it was : without O_DIRECT
+      int fd( ::open( file.path.c_str(), O_RDONLY ) );
+      BOOST_REQUIRE( fd >= 0 );
+      hashes::Digest<hashes::SHA256> digest;
+      hashes::hashFile<hashes::SHA256>( fd, digest, direct );
+      BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( content ) );
+#ifdef O_DIRECT
+      BOOST_CHECK_EQUAL( ::fcntl( fd, F_GETFL ) & O_DIRECT, 0 );
+#endif
+      ::close( fd );
+   }
+
+   // Not a regular file : read as usual
+   int pipeFds[2];
+   BOOST_REQUIRE( ::pipe( pipeFds ) == 0 );
+   BOOST_REQUIRE( ::write( pipeFds[1], "abc", 3 ) == 3 );
+   ::close( pipeFds[1] );
+   hashes::Digest<hashes::SHA256> digest;
+   hashes::hashFile<hashes::SHA256>( pipeFds[0], digest, direct );
+   ::close( pipeFds[0] );
+   BOOST_CHECK_EQUAL( digest, hashes::hashDigest<hashes::SHA256>( "abc" ) );
+}
+
+BOOST_AUTO_TEST_CASE( sparse_file_hashing )
+{
+   std::string const data( 70000, 'd' );
+   std::size_t const unit( 1 << 18 );
+
+   // Extents as ( offset, length ) pairs, then the size of the file
+   struct Layout { std::vector< std::pair< std::size_t, std::size_t > > extents; std::size_t size; };
+   std::vector< Layout > const layouts = {
+         { {}, 10 * unit },                                      // nothing but a hole
+         { { { 0, 5000 } }, 6 * unit + 17 },                     // data, then a hole
+         { { { 5 * unit + 100, 4000 } }, 5 * unit + 4100 },      // hole, then data to the end
+         { { { 1 * unit, 70000 }, { 8 * unit + 4096, 10 },       // across huge pages
+             { 9 * unit - 1, 1 } }, 12 * unit + 3 } };
+
+   hashes::FileOptions smallWindows;
+   smallWindows.windowSize = 1;
+   hashes::FileOptions readLoop;
+   readLoop.forceRead = true;
+   readLoop.bufferSize = 1000;
+   hashes::FileOptions dense;
+   dense.skipHoles = false;
+
+   for( Layout const& layout : layouts )
+   {
+      std::string content( layout.size, '\0' );
+      TempFile file( "" );
+      int fd( ::open( file.path.c_str(), O_WRONLY ) );
+      BOOST_REQUIRE( fd >= 0 );
+      BOOST_REQUIRE( ::ftruncate( fd, static_cast< off_t >( layout.size ) ) == 0 );
+      for( auto const& extent : layout.extents )
+      {
+         content.replace( extent.first, extent.second, data, 0, extent.second );
+         BOOST_REQUIRE( ::pwrite( fd, data.data(), extent.second,
+                                  static_cast< off_t >( extent.first ) ) ==
+                        static_cast< ssize_t >( extent.second ) );
+      }
+      ::close( fd );
+
+      std::string const expected( hashes::hashStrg<hashes::SHA256>( content ) );
+      for( hashes::FileOptions const& options : { hashes::FileOptions(), smallWindows, readLoop, dense } )
+      {
+         BOOST_CHECK_EQUAL( expected, hashes::hashFile<hashes::SHA256>( file.path, options ) );
+      }
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::SHA512>( content ),
+                         hashes::hashFile<hashes::SHA512>( file.path ) );
+      BOOST_CHECK_EQUAL( hashes::hashStrg<hashes::MD5>( content ),
+                         hashes::hashFile<hashes::MD5>( file.path, readLoop ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( file_batch_hashing )
+{
+   std::vector< std::string > contents;
+   for( std::size_t size : { 0, 3, 63, 64, 65, 1000, 4096, 70000, 300000 } )
+   {
+      std::string content( size, '\0' );
+      for( std::size_t idx( 0 ); idx != size; ++idx )
+      {
+         content[idx] = static_cast< char >( idx * 29 + size );
+      }
+      contents.push_back( content );
+   }
+   std::vector< std::unique_ptr< TempFile > > files;
+   std::vector< std::string > paths;
+   for( std::size_t idx( 0 ); idx != 40; ++idx )
+   {
+      files.push_back( std::make_unique< TempFile >( contents[idx % contents.size()] ) );
+      paths.push_back( files.back()->path );
+   }
+   paths.insert( paths.begin() + 7, "/tmp/hdqrt_hash_does_not_exist" );
+   paths.push_back( "/tmp" );      // opens, but cannot be read
+
+   auto check = [&]( hashes::BatchOptions const& options )
+   {
+      auto const results( hashes::hashFiles<hashes::SHA256>( paths, options ) );
+      BOOST_REQUIRE_EQUAL( results.size(), paths.size() );
+      for( std::size_t idx( 0 ), file( 0 ); idx != paths.size(); ++idx )
+      {
+         if( idx == 7 )
+         {
+            BOOST_CHECK_EQUAL( results[idx].error, ENOENT );
+            continue;
+         }
+         if( idx + 1 == paths.size() )
+         {
+            BOOST_CHECK_EQUAL( results[idx].error, EISDIR );
+            continue;
+         }
+         BOOST_CHECK_EQUAL( results[idx].error, 0 );
+         BOOST_CHECK_EQUAL( results[idx].digest, hashes::hashDigest<hashes::SHA256>(
+                                                      contents[file % contents.size()] ) );
+         ++file;
+      }
+   };
 
+   hashes::BatchOptions defaults;
+   check( defaults );
 
-//   SHA224("")
-//   0x d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f
-//   SHA256("")
-//   0x e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855
-//   SHA384("")
-//   0x 38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b
-//   SHA512("")
-//   0x cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e
-//   SHA512/224("")
-//   0x 6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4
-//   SHA512/256("")
-//   0x c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a
+   // Fewer slots than files, buffers smaller than most files
+   hashes::BatchOptions shallow;
+   shallow.queueDepth = 3;
+   shallow.bufferSize = 1000;      // rounded down to whole chunks
+   check( shallow );
 
+   hashes::BatchOptions withWorkers( shallow );
+   withWorkers.workers = 2;
+   check( withWorkers );
 
+   hashes::BatchOptions pool( shallow );
+   pool.forceThreadPool = true;
+   check( pool );
+   pool.queueDepth = 1;
+   check( pool );
 
+   BOOST_CHECK( hashes::hashFiles<hashes::MD5>( {} ).empty() );
+   BOOST_TEST_MESSAGE( "io_uring available : " << hashes::ioUringAvailable() );
 }
+#endif // HDQRT_POSIX_FILES
 
 BOOST_AUTO_TEST_SUITE_END()